@@ -0,0 +1,197 @@
+/**
+ * @file        base/core/frame_arena.h
+ * @brief       per frame linear allocator with stl allocator adaptor
+ * @author      yy
+ * @email       syby119@126.com
+ * @date        2026/10/19
+ * @copyright   MIT license
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <vector>
+
+#include "memory_tracker.h"
+
+/**
+ * @brief bump allocator for temporaries that live until the end of a frame
+ * @detail memory is only given back as a whole by reset. A request that does
+ *         not fit the current block takes a new block from the heap, and reset
+ *         merges all blocks into one, so a frame no larger than the largest
+ *         frame so far runs without touching the heap.
+ */
+class FrameArena {
+public:
+    /**
+     * @brief constructor
+     * @param blockSize bytes of the first block
+     */
+    explicit FrameArena(size_t blockSize = 1 << 20) {
+        _blocks.push_back(_allocateBlock(std::max<size_t>(blockSize, 64)));
+    }
+
+    /**
+     * @brief destructor, free all blocks
+     */
+    ~FrameArena() {
+        for (auto& block : _blocks) {
+            _freeBlock(block);
+        }
+    }
+
+    FrameArena(const FrameArena&) = delete;
+
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    /**
+     * @brief allocate uninitialized memory valid until the next reset
+     */
+    void* allocate(size_t size, size_t alignment = alignof(std::max_align_t)) {
+        Block* block = &_blocks[_blockIndex];
+        size_t offset = _align(_offset, alignment);
+        if (offset + size > block->size) {
+            _blockIndex = _blocks.size();
+            _blocks.push_back(_allocateBlock(std::max(block->size * 2, size + alignment)));
+            block = &_blocks[_blockIndex];
+            // the fill of the previous block stays counted
+            _offset = 0;
+            offset = 0;
+        }
+
+        void* data = block->data + offset;
+        _usedBytes += offset + size - _offset;
+        _offset = offset + size;
+        _peakBytes = std::max(_peakBytes, _usedBytes);
+
+        return data;
+    }
+
+    /**
+     * @brief allocate an uninitialized array valid until the next reset
+     */
+    template <typename T>
+    T* allocateArray(size_t count) {
+        return static_cast<T*>(allocate(count * sizeof(T), alignof(T)));
+    }
+
+    /**
+     * @brief give back everything allocated since the last reset
+     * @note objects in the arena are not destroyed, destroy them beforehand
+     */
+    void reset() {
+        if (_blocks.size() > 1) {
+            size_t capacity = 0;
+            for (auto& block : _blocks) {
+                capacity += block.size;
+                _freeBlock(block);
+            }
+
+            _blocks.clear();
+            _blocks.push_back(_allocateBlock(capacity));
+        }
+
+        _blockIndex = 0;
+        _offset = 0;
+        _usedBytes = 0;
+    }
+
+    /**
+     * @brief get the bytes allocated since the last reset, padding included
+     */
+    size_t getUsedBytes() const noexcept {
+        return _usedBytes;
+    }
+
+    /**
+     * @brief get the most bytes used between two resets
+     */
+    size_t getPeakBytes() const noexcept {
+        return _peakBytes;
+    }
+
+    size_t getCapacity() const noexcept {
+        size_t capacity = 0;
+        for (const auto& block : _blocks) {
+            capacity += block.size;
+        }
+
+        return capacity;
+    }
+
+private:
+    struct Block {
+        unsigned char* data;
+        size_t size;
+    };
+
+    std::vector<Block> _blocks;
+
+    /* next allocation at _offset of _blocks[_blockIndex] */
+    size_t _blockIndex = 0;
+    size_t _offset = 0;
+
+    size_t _usedBytes = 0;
+    size_t _peakBytes = 0;
+
+    static Block _allocateBlock(size_t size) {
+        Block block{ static_cast<unsigned char*>(::operator new(size)), size };
+        MemoryTracker::get().allocate(MemoryTag::FrameArena, size);
+        return block;
+    }
+
+    static void _freeBlock(const Block& block) noexcept {
+        MemoryTracker::get().free(MemoryTag::FrameArena, block.size);
+        ::operator delete(block.data);
+    }
+
+    static size_t _align(size_t offset, size_t alignment) noexcept {
+        return (offset + alignment - 1) & ~(alignment - 1);
+    }
+};
+
+/**
+ * @brief stl allocator drawing from a frame arena, deallocate does nothing
+ * @note a container must be destroyed before the arena is reset, some
+ *       standard libraries allocate a sentinel as soon as it is constructed
+ */
+template <typename T>
+class ArenaAllocator {
+public:
+    using value_type = T;
+
+    explicit ArenaAllocator(FrameArena* arena) noexcept : _arena(arena) { }
+
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) noexcept : _arena(other.getArena()) { }
+
+    T* allocate(size_t count) {
+        return static_cast<T*>(_arena->allocate(count * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T*, size_t) noexcept { }
+
+    FrameArena* getArena() const noexcept {
+        return _arena;
+    }
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U>& other) const noexcept {
+        return _arena == other.getArena();
+    }
+
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U>& other) const noexcept {
+        return _arena != other.getArena();
+    }
+
+private:
+    FrameArena* _arena;
+};
+
+/* vector whose storage lives in a frame arena */
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
@@ -0,0 +1,399 @@
+/**
+ * @file        base/core/job_system.h
+ * @brief       work stealing job system with task groups and parallel for
+ * @author      yy
+ * @email       syby119@126.com
+ * @date        2026/10/19
+ * @copyright   MIT license
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#ifdef _WIN32
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+#elif defined(__linux__)
+    #include <pthread.h>
+    #include <sched.h>
+#endif
+
+#include "profiler.h"
+
+class TaskGroup;
+
+/**
+ * @brief fixed pool of workers, each with its own queue of jobs
+ * @detail a worker takes the newest job of its own queue and steals the
+ *         oldest job of another queue once its own is empty. Threads outside
+ *         the pool submit into a shared queue. A job is a trivially copyable
+ *         callable stored inline, so submitting never allocates. A thread
+ *         waiting on a TaskGroup runs jobs meanwhile, hence nested parallelism
+ *         does not deadlock and a pool without workers still makes progress.
+ */
+class JobSystem {
+public:
+    struct Options {
+        /* worker threads, negative for one per hardware thread besides the caller */
+        int workerCount = -1;
+        /* jobs a queue holds, a job submitted to a full queue runs at once */
+        int queueCapacity = 1024;
+        /* bind worker i to hardware thread i + 1, the first is left to the caller */
+        bool pinThreads = false;
+    };
+
+    /**
+     * @brief job, a callable and its captures stored inline
+     */
+    struct Job {
+        static constexpr size_t storageSize = 48;
+
+        void (*invoke)(const Job& job) = nullptr;
+        TaskGroup* group = nullptr;
+        alignas(std::max_align_t) unsigned char storage[storageSize];
+    };
+
+    /**
+     * @brief set the options of the pool returned by get, call before its first use
+     */
+    static void setDefaultOptions(const Options& options) {
+        _getDefaultOptions() = options;
+    }
+
+    /**
+     * @brief get the pool shared by the whole process
+     */
+    static JobSystem& get() {
+        static JobSystem jobSystem(_getDefaultOptions());
+        return jobSystem;
+    }
+
+    /**
+     * @brief constructor, start the workers
+     */
+    explicit JobSystem(const Options& options) {
+        int workerCount = options.workerCount;
+        if (workerCount < 0) {
+            workerCount = static_cast<int>(std::max(std::thread::hardware_concurrency(), 1u)) - 1;
+        }
+
+        size_t capacity = 1;
+        while (capacity < static_cast<size_t>(std::max(options.queueCapacity, 1))) {
+            capacity <<= 1;
+        }
+
+        // queue 0 is shared by the threads outside the pool
+        for (int i = 0; i < workerCount + 1; ++i) {
+            _queues.push_back(std::make_unique<WorkQueue>(capacity));
+        }
+
+        for (int i = 0; i < workerCount; ++i) {
+            _workers.emplace_back(&JobSystem::_run, this, i + 1);
+            if (options.pinThreads) {
+                _pin(_workers.back(), i + 1);
+            }
+        }
+    }
+
+    /**
+     * @brief destructor, run the pending jobs and stop the workers
+     */
+    ~JobSystem() {
+        {
+            std::lock_guard<std::mutex> lock(_sleepMutex);
+            _stopping = true;
+        }
+        _sleepCondition.notify_all();
+
+        for (auto& worker : _workers) {
+            worker.join();
+        }
+    }
+
+    JobSystem(const JobSystem&) = delete;
+
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    int getWorkerCount() const noexcept {
+        return static_cast<int>(_workers.size());
+    }
+
+    /**
+     * @brief submit a job into the queue of the calling thread
+     */
+    void submit(const Job& job) {
+        _queuedCount.fetch_add(1, std::memory_order_relaxed);
+        if (!_queues[_getQueueIndex()]->push(job)) {
+            _queuedCount.fetch_sub(1, std::memory_order_relaxed);
+            _execute(job);
+            return;
+        }
+
+        // an empty critical section orders the count before a worker falls asleep
+        {
+            std::lock_guard<std::mutex> lock(_sleepMutex);
+        }
+        _sleepCondition.notify_one();
+    }
+
+    /**
+     * @brief run one pending job on the calling thread
+     * @return false if no job is pending
+     */
+    bool runPendingJob() {
+        const size_t queueCount = _queues.size();
+        const size_t first = _getQueueIndex();
+
+        Job job;
+        if (_queues[first]->pop(job)) {
+            _queuedCount.fetch_sub(1, std::memory_order_relaxed);
+            _execute(job);
+            return true;
+        }
+
+        for (size_t i = 1; i < queueCount; ++i) {
+            if (_queues[(first + i) % queueCount]->steal(job)) {
+                _queuedCount.fetch_sub(1, std::memory_order_relaxed);
+                _execute(job);
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    /**
+     * @brief call function(i) for i in [begin, end), blocks until all calls return
+     * @param grainSize consecutive indices handed out at once
+     */
+    template <typename Function>
+    void parallelFor(int begin, int end, int grainSize, const Function& function);
+
+private:
+    /**
+     * @brief ring of jobs, the owner works at the head, thieves take from the tail
+     */
+    struct alignas(64) WorkQueue {
+        std::mutex mutex;
+        std::vector<Job> jobs;
+        /* jobs in [tail, head) */
+        uint64_t head = 0;
+        uint64_t tail = 0;
+
+        explicit WorkQueue(size_t capacity) : jobs(capacity) { }
+
+        bool push(const Job& job) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (head - tail == jobs.size()) {
+                return false;
+            }
+
+            jobs[head++ & (jobs.size() - 1)] = job;
+            return true;
+        }
+
+        bool pop(Job& job) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (head == tail) {
+                return false;
+            }
+
+            job = jobs[--head & (jobs.size() - 1)];
+            return true;
+        }
+
+        bool steal(Job& job) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (head == tail) {
+                return false;
+            }
+
+            job = jobs[tail++ & (jobs.size() - 1)];
+            return true;
+        }
+    };
+
+    std::vector<std::unique_ptr<WorkQueue>> _queues;
+
+    std::vector<std::thread> _workers;
+
+    /* jobs submitted and not taken yet, wakes the sleeping workers */
+    std::atomic<int64_t> _queuedCount{ 0 };
+
+    std::mutex _sleepMutex;
+
+    std::condition_variable _sleepCondition;
+
+    bool _stopping = false;
+
+    static Options& _getDefaultOptions() {
+        static Options options;
+        return options;
+    }
+
+    /**
+     * @brief get the queue of the calling thread, 0 outside of this pool
+     */
+    size_t _getQueueIndex() const noexcept {
+        const auto& worker = _getCurrentWorker();
+        return worker.jobSystem == this ? worker.queueIndex : 0;
+    }
+
+    struct CurrentWorker {
+        const JobSystem* jobSystem = nullptr;
+        size_t queueIndex = 0;
+    };
+
+    static CurrentWorker& _getCurrentWorker() noexcept {
+        thread_local CurrentWorker worker;
+        return worker;
+    }
+
+    void _run(size_t queueIndex) {
+        _getCurrentWorker() = CurrentWorker{ this, queueIndex };
+        PROFILE_THREAD_NAME("worker " + std::to_string(queueIndex));
+
+        while (true) {
+            if (runPendingJob()) {
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(_sleepMutex);
+            _sleepCondition.wait(lock, [this]() {
+                return _stopping || _queuedCount.load(std::memory_order_relaxed) > 0;
+            });
+
+            if (_stopping && _queuedCount.load(std::memory_order_relaxed) <= 0) {
+                return;
+            }
+        }
+    }
+
+    static void _execute(const Job& job);
+
+    static void _pin(std::thread& thread, int hardwareThread) {
+        const int hardwareThreadCount = static_cast<int>(std::max(std::thread::hardware_concurrency(), 1u));
+        hardwareThread %= hardwareThreadCount;
+#ifdef _WIN32
+        SetThreadAffinityMask(thread.native_handle(), DWORD_PTR(1) << (hardwareThread % 64));
+#elif defined(__linux__)
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(hardwareThread, &cpus);
+        pthread_setaffinity_np(thread.native_handle(), sizeof(cpus), &cpus);
+#else
+        (void)thread;
+#endif
+    }
+};
+
+/**
+ * @brief jobs that are waited for together
+ * @detail the captures of a job are copied bytewise, capture by reference
+ *         or pointer. The group waits for its jobs when it is destroyed.
+ */
+class TaskGroup {
+public:
+    explicit TaskGroup(JobSystem& jobSystem = JobSystem::get()) noexcept : _jobSystem(jobSystem) { }
+
+    ~TaskGroup() {
+        wait();
+    }
+
+    TaskGroup(const TaskGroup&) = delete;
+
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    /**
+     * @brief submit a callable to the job system
+     */
+    template <typename Function>
+    void run(const Function& function) {
+        static_assert(sizeof(Function) <= JobSystem::Job::storageSize,
+            "captures too large for a job, capture a pointer to them instead");
+        static_assert(alignof(Function) <= alignof(std::max_align_t), "over aligned job");
+        static_assert(std::is_trivially_copyable<Function>::value &&
+            std::is_trivially_destructible<Function>::value,
+            "jobs are copied bytewise, capture by reference or pointer");
+
+        JobSystem::Job job;
+        new (job.storage) Function(function);
+        job.invoke = [](const JobSystem::Job& job) {
+            (*std::launder(reinterpret_cast<const Function*>(job.storage)))();
+        };
+        job.group = this;
+
+        _pendingCount.fetch_add(1, std::memory_order_relaxed);
+        _jobSystem.submit(job);
+    }
+
+    /**
+     * @brief run pending jobs until all jobs of the group are done
+     */
+    void wait() {
+        while (_pendingCount.load(std::memory_order_acquire) > 0) {
+            if (!_jobSystem.runPendingJob()) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+private:
+    friend class JobSystem;
+
+    JobSystem& _jobSystem;
+
+    std::atomic<int> _pendingCount{ 0 };
+};
+
+inline void JobSystem::_execute(const Job& job) {
+    job.invoke(job);
+    if (job.group != nullptr) {
+        job.group->_pendingCount.fetch_sub(1, std::memory_order_release);
+    }
+}
+
+template <typename Function>
+void JobSystem::parallelFor(int begin, int end, int grainSize, const Function& function) {
+    if (begin >= end) {
+        return;
+    }
+
+    grainSize = std::max(grainSize, 1);
+    const int chunkCount = (end - begin + grainSize - 1) / grainSize;
+
+    // every job claims chunks until none is left, so a slow thread delays no other
+    std::atomic<int> nextChunk{ 0 };
+    auto runChunks = [&nextChunk, &function, chunkCount, begin, end, grainSize]() {
+        for (int chunk = nextChunk++; chunk < chunkCount; chunk = nextChunk++) {
+            const int first = begin + chunk * grainSize;
+            const int last = std::min(first + grainSize, end);
+            for (int i = first; i < last; ++i) {
+                function(i);
+            }
+        }
+    };
+
+    TaskGroup group(*this);
+    const int jobCount = std::min(getWorkerCount(), chunkCount - 1);
+    for (int i = 0; i < jobCount; ++i) {
+        group.run(runChunks);
+    }
+
+    runChunks();
+    group.wait();
+}
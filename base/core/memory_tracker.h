@@ -0,0 +1,285 @@
+/**
+ * @file        base/core/memory_tracker.h
+ * @brief       current and peak memory per subsystem tag
+ * @author      yy
+ * @email       syby119@126.com
+ * @date        2026/10/19
+ * @copyright   MIT license
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+/**
+ * @brief subsystem an allocation is accounted to
+ */
+enum class MemoryTag {
+    Meshes,
+    Framebuffer,
+    Depth,
+    QuadTree,
+    Octree,
+    Clusters,
+    SceneTree,
+    VisibleSet,
+    FrameArena,
+    Other,
+    Count
+};
+
+/**
+ * @brief counts the bytes registered per tag, the heap itself is untouched
+ * @detail subsystems register their memory either per allocation through
+ *         TrackingAllocator or as a whole through MemoryRegistration. The
+ *         counters are atomic, so any thread may register.
+ */
+class MemoryTracker {
+public:
+    static constexpr int tagCount = static_cast<int>(MemoryTag::Count);
+
+    struct TagSummary {
+        enum MemoryTag tag;
+        const char* name;
+        int64_t currentBytes = 0;
+        int64_t peakBytes = 0;
+        /* registrations since the start, not the live ones */
+        uint64_t allocationCount = 0;
+    };
+
+    /**
+     * @brief get the tracker of the process
+     */
+    static MemoryTracker& get() {
+        static MemoryTracker tracker;
+        return tracker;
+    }
+
+    MemoryTracker(const MemoryTracker&) = delete;
+
+    MemoryTracker& operator=(const MemoryTracker&) = delete;
+
+    static const char* getTagName(enum MemoryTag tag) noexcept {
+        switch (tag) {
+        case MemoryTag::Meshes:
+            return "meshes";
+        case MemoryTag::Framebuffer:
+            return "framebuffer";
+        case MemoryTag::Depth:
+            return "depth";
+        case MemoryTag::QuadTree:
+            return "quadtree";
+        case MemoryTag::Octree:
+            return "octree";
+        case MemoryTag::Clusters:
+            return "clusters";
+        case MemoryTag::SceneTree:
+            return "scene tree";
+        case MemoryTag::VisibleSet:
+            return "visible set";
+        case MemoryTag::FrameArena:
+            return "frame arena";
+        case MemoryTag::Other:
+        case MemoryTag::Count:
+            break;
+        }
+
+        return "other";
+    }
+
+    /**
+     * @brief account bytes allocated by a subsystem
+     */
+    void allocate(enum MemoryTag tag, size_t bytes) noexcept {
+        Counter& counter = _counters[static_cast<int>(tag)];
+        const int64_t current = counter.currentBytes.fetch_add(
+            static_cast<int64_t>(bytes), std::memory_order_relaxed) + static_cast<int64_t>(bytes);
+        counter.allocationCount.fetch_add(1, std::memory_order_relaxed);
+
+        int64_t peak = counter.peakBytes.load(std::memory_order_relaxed);
+        while (peak < current &&
+            !counter.peakBytes.compare_exchange_weak(peak, current, std::memory_order_relaxed)) {
+        }
+    }
+
+    /**
+     * @brief account bytes given back by a subsystem
+     */
+    void free(enum MemoryTag tag, size_t bytes) noexcept {
+        _counters[static_cast<int>(tag)].currentBytes.fetch_sub(
+            static_cast<int64_t>(bytes), std::memory_order_relaxed);
+    }
+
+    TagSummary getSummary(enum MemoryTag tag) const noexcept {
+        const Counter& counter = _counters[static_cast<int>(tag)];
+
+        TagSummary summary{ tag, getTagName(tag) };
+        summary.currentBytes = counter.currentBytes.load(std::memory_order_relaxed);
+        summary.peakBytes = counter.peakBytes.load(std::memory_order_relaxed);
+        summary.allocationCount = counter.allocationCount.load(std::memory_order_relaxed);
+
+        return summary;
+    }
+
+    /**
+     * @brief get the summary of every tag that registered any memory
+     */
+    std::vector<TagSummary> getSummary() const {
+        std::vector<TagSummary> summary;
+        for (int i = 0; i < tagCount; ++i) {
+            const TagSummary tag = getSummary(static_cast<enum MemoryTag>(i));
+            if (tag.allocationCount > 0) {
+                summary.push_back(tag);
+            }
+        }
+
+        return summary;
+    }
+
+    /**
+     * @brief print the current and peak bytes of every tag
+     */
+    void printSummary(std::ostream& out = std::cout) const {
+        out << std::left << std::setw(16) << "memory"
+            << std::right << std::setw(14) << "current MiB"
+            << std::setw(14) << "peak MiB"
+            << std::setw(14) << "allocations" << "\n";
+
+        int64_t currentBytes = 0;
+        int64_t peakBytes = 0;
+        for (const auto& tag : getSummary()) {
+            out << std::left << std::setw(16) << tag.name
+                << std::right << std::fixed << std::setprecision(3)
+                << std::setw(14) << tag.currentBytes / (1024.0 * 1024.0)
+                << std::setw(14) << tag.peakBytes / (1024.0 * 1024.0)
+                << std::setw(14) << tag.allocationCount << "\n";
+            currentBytes += tag.currentBytes;
+            peakBytes += tag.peakBytes;
+        }
+
+        // the peaks of the tags need not coincide, their sum bounds the total peak
+        out << std::left << std::setw(16) << "total"
+            << std::right << std::fixed << std::setprecision(3)
+            << std::setw(14) << currentBytes / (1024.0 * 1024.0)
+            << std::setw(14) << peakBytes / (1024.0 * 1024.0) << "\n" << std::flush;
+    }
+
+private:
+    struct Counter {
+        std::atomic<int64_t> currentBytes{ 0 };
+        std::atomic<int64_t> peakBytes{ 0 };
+        std::atomic<uint64_t> allocationCount{ 0 };
+    };
+
+    Counter _counters[tagCount];
+
+    MemoryTracker() = default;
+};
+
+/**
+ * @brief stl allocator accounting its memory to a tag
+ */
+template <typename T, enum MemoryTag tag>
+class TrackingAllocator {
+public:
+    using value_type = T;
+
+    template <typename U>
+    struct rebind {
+        using other = TrackingAllocator<U, tag>;
+    };
+
+    TrackingAllocator() noexcept = default;
+
+    template <typename U>
+    TrackingAllocator(const TrackingAllocator<U, tag>&) noexcept { }
+
+    T* allocate(size_t count) {
+        T* data = static_cast<T*>(::operator new(count * sizeof(T)));
+        MemoryTracker::get().allocate(tag, count * sizeof(T));
+        return data;
+    }
+
+    void deallocate(T* data, size_t count) noexcept {
+        MemoryTracker::get().free(tag, count * sizeof(T));
+        ::operator delete(data);
+    }
+
+    template <typename U>
+    bool operator==(const TrackingAllocator<U, tag>&) const noexcept {
+        return true;
+    }
+
+    template <typename U>
+    bool operator!=(const TrackingAllocator<U, tag>&) const noexcept {
+        return false;
+    }
+};
+
+/**
+ * @brief accounts a block of memory to a tag while it lives,
+ *        e.g. a buffer allocated with new[] or a mapped file
+ */
+class MemoryRegistration {
+public:
+    explicit MemoryRegistration(enum MemoryTag tag, size_t bytes = 0) noexcept : _tag(tag) {
+        resize(bytes);
+    }
+
+    ~MemoryRegistration() {
+        resize(0);
+    }
+
+    MemoryRegistration(const MemoryRegistration&) = delete;
+
+    MemoryRegistration& operator=(const MemoryRegistration&) = delete;
+
+    MemoryRegistration(MemoryRegistration&& other) noexcept : _tag(other._tag), _bytes(other._bytes) {
+        other._bytes = 0;
+    }
+
+    MemoryRegistration& operator=(MemoryRegistration&& other) noexcept {
+        if (this != &other) {
+            resize(0);
+            _tag = other._tag;
+            _bytes = other._bytes;
+            other._bytes = 0;
+        }
+
+        return *this;
+    }
+
+    /**
+     * @brief set the bytes accounted, e.g. after the owner grew or shrank
+     */
+    void resize(size_t bytes) noexcept {
+        if (bytes == _bytes) {
+            return;
+        }
+
+        if (_bytes > 0) {
+            MemoryTracker::get().free(_tag, _bytes);
+        }
+
+        if (bytes > 0) {
+            MemoryTracker::get().allocate(_tag, bytes);
+        }
+
+        _bytes = bytes;
+    }
+
+    size_t getBytes() const noexcept {
+        return _bytes;
+    }
+
+private:
+    enum MemoryTag _tag;
+    size_t _bytes = 0;
+};
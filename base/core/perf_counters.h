@@ -0,0 +1,310 @@
+/**
+ * @file        base/core/perf_counters.h
+ * @brief       hardware performance counters of named stages, linux only
+ * @author      yy
+ * @email       syby119@126.com
+ * @date        2026/10/19
+ * @copyright   MIT license
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <cerrno>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @brief counts cycles, instructions, cache and branch misses of the calling
+ *        thread and the threads it starts afterwards, the latter only once
+ *        they exit, so long lived workers, e.g. of the JobSystem, are missed
+ * @detail every event is opened on its own, so an event the cpu or the
+ *         kernel does not offer only disables itself. Without counters at
+ *         all, e.g. on windows or with a restrictive perf_event_paranoid,
+ *         every read returns invalid values and the caller goes on as usual.
+ */
+class PerfCounters {
+public:
+    enum class Event {
+        Cycles, Instructions, L1DataMisses, LastLevelCacheMisses, BranchMisses, Count
+    };
+
+    static constexpr int eventCount = static_cast<int>(Event::Count);
+
+    struct Sample {
+        uint64_t values[eventCount] = {};
+        bool valid[eventCount] = {};
+
+        uint64_t operator[](enum Event event) const noexcept {
+            return values[static_cast<int>(event)];
+        }
+
+        bool isValid(enum Event event) const noexcept {
+            return valid[static_cast<int>(event)];
+        }
+
+        /**
+         * @brief get the counts from an earlier sample to this one
+         */
+        Sample operator-(const Sample& earlier) const noexcept {
+            Sample delta;
+            for (int i = 0; i < eventCount; ++i) {
+                delta.valid[i] = valid[i] && earlier.valid[i];
+                delta.values[i] = delta.valid[i] ? values[i] - earlier.values[i] : 0;
+            }
+            return delta;
+        }
+
+        Sample& operator+=(const Sample& other) noexcept {
+            for (int i = 0; i < eventCount; ++i) {
+                values[i] += other.values[i];
+                valid[i] = other.valid[i];
+            }
+            return *this;
+        }
+    };
+
+    /**
+     * @brief constructor, open and start the counters
+     */
+    PerfCounters() {
+#ifdef __linux__
+        static const struct {
+            uint32_t type;
+            uint64_t config;
+        } events[eventCount] = {
+            { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+            { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+            { PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D |
+                (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+            { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+            { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+        };
+
+        for (int i = 0; i < eventCount; ++i) {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = events[i].type;
+            attr.config = events[i].config;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            // threads started later count into the same value when they exit
+            attr.inherit = 1;
+            // scale the counts if the events share the hardware counters
+            attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+            _fds[i] = static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+            if (_fds[i] == -1 && _error.empty()) {
+                _error = std::strerror(errno);
+            }
+        }
+#else
+        _error = "hardware counters are only supported on linux";
+#endif
+    }
+
+    /**
+     * @brief destructor, close the counters
+     */
+    ~PerfCounters() {
+#ifdef __linux__
+        for (int fd : _fds) {
+            if (fd != -1) {
+                close(fd);
+            }
+        }
+#endif
+    }
+
+    PerfCounters(const PerfCounters&) = delete;
+
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    /**
+     * @brief check if any event can be counted
+     */
+    bool isAvailable() const noexcept {
+        for (int fd : _fds) {
+            if (fd != -1) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool isAvailable(enum Event event) const noexcept {
+        return _fds[static_cast<int>(event)] != -1;
+    }
+
+    /**
+     * @brief get the reason the first unavailable event failed to open
+     */
+    const std::string& getError() const noexcept {
+        return _error;
+    }
+
+    /**
+     * @brief read the running counts, subtract two samples to count a stage
+     */
+    Sample read() const noexcept {
+        Sample sample;
+#ifdef __linux__
+        for (int i = 0; i < eventCount; ++i) {
+            uint64_t data[3] = {};
+            if (_fds[i] != -1 && ::read(_fds[i], data, sizeof(data)) == sizeof(data) && data[2] > 0) {
+                sample.values[i] = data[2] < data[1] ?
+                    static_cast<uint64_t>(static_cast<double>(data[0]) * data[1] / data[2]) : data[0];
+                sample.valid[i] = true;
+            }
+        }
+#endif
+        return sample;
+    }
+
+private:
+    int _fds[eventCount] = { -1, -1, -1, -1, -1 };
+
+    std::string _error;
+};
+
+/**
+ * @brief accumulates the counts of named stages over frames
+ */
+class PerfStages {
+public:
+    struct Stage {
+        std::string name;
+        uint64_t count = 0;
+        PerfCounters::Sample total;
+    };
+
+    /**
+     * @brief counts the enclosing scope into a stage, no op without stages
+     */
+    class Scope {
+    public:
+        Scope(PerfStages* stages, const char* name) noexcept : _stages(stages), _name(name) {
+            if (_stages != nullptr) {
+                _begin = _stages->_counters.read();
+            }
+        }
+
+        ~Scope() {
+            if (_stages != nullptr) {
+                _stages->add(_name, _stages->_counters.read() - _begin);
+            }
+        }
+
+        Scope(const Scope&) = delete;
+
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        PerfStages* _stages;
+        const char* _name;
+        PerfCounters::Sample _begin;
+    };
+
+    const PerfCounters& getCounters() const noexcept {
+        return _counters;
+    }
+
+    /**
+     * @brief add the counts of one run of a stage
+     */
+    void add(const char* name, const PerfCounters::Sample& delta) {
+        for (auto& stage : _stages) {
+            if (stage.name == name) {
+                ++stage.count;
+                stage.total += delta;
+                return;
+            }
+        }
+
+        _stages.push_back(Stage{ name, 1, delta });
+    }
+
+    const std::vector<Stage>& getStages() const noexcept {
+        return _stages;
+    }
+
+    /**
+     * @brief forget the counts of all stages
+     */
+    void clear() noexcept {
+        _stages.clear();
+    }
+
+    /**
+     * @brief print per run cycles and instructions, IPC and misses per pixel
+     * @param pixelCount pixels per run, e.g. the image resolution per frame
+     */
+    void print(uint64_t pixelCount, std::ostream& out = std::cout) const {
+        using Event = PerfCounters::Event;
+
+        if (!_counters.isAvailable()) {
+            out << "hardware counters unavailable: " << _counters.getError() << std::endl;
+            return;
+        }
+
+        out << std::left << std::setw(20) << "stage"
+            << std::right << std::setw(14) << "cycles"
+            << std::setw(14) << "instructions"
+            << std::setw(8) << "IPC"
+            << std::setw(14) << "L1D miss/px"
+            << std::setw(14) << "LLC miss/px"
+            << std::setw(14) << "branch miss/px" << "\n";
+
+        for (const auto& stage : _stages) {
+            const double runs = static_cast<double>(stage.count);
+            const double pixels = runs * std::max<uint64_t>(pixelCount, 1);
+            auto perRun = [&](Event event) -> std::string {
+                return stage.total.isValid(event) ? std::to_string(static_cast<uint64_t>(stage.total[event] / runs)) : "n/a";
+            };
+            auto perPixel = [&](Event event) -> std::string {
+                return stage.total.isValid(event) ? _format(stage.total[event] / pixels) : "n/a";
+            };
+
+            std::string ipc = "n/a";
+            if (stage.total.isValid(Event::Cycles) && stage.total.isValid(Event::Instructions) &&
+                stage.total[Event::Cycles] > 0) {
+                ipc = _format(1.0 * stage.total[Event::Instructions] / stage.total[Event::Cycles]);
+            }
+
+            out << std::left << std::setw(20) << stage.name
+                << std::right << std::setw(14) << perRun(Event::Cycles)
+                << std::setw(14) << perRun(Event::Instructions)
+                << std::setw(8) << ipc
+                << std::setw(14) << perPixel(Event::L1DataMisses)
+                << std::setw(14) << perPixel(Event::LastLevelCacheMisses)
+                << std::setw(14) << perPixel(Event::BranchMisses) << "\n";
+        }
+
+        out << std::flush;
+    }
+
+private:
+    PerfCounters _counters;
+
+    /* few stages, kept in the order they first ran */
+    std::vector<Stage> _stages;
+
+    static std::string _format(double value) {
+        char text[32];
+        std::snprintf(text, sizeof(text), "%.3f", value);
+        return text;
+    }
+};
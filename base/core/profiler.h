@@ -0,0 +1,384 @@
+/**
+ * @file        base/core/profiler.h
+ * @brief       scoped cpu profiler with chrome trace export
+ * @author      yy
+ * @email       syby119@126.com
+ * @date        2026/10/19
+ * @copyright   MIT license
+ */
+
+#pragma once
+
+//#define ENABLE_PROFILER
+//#define ENABLE_PROFILER_DETAIL
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @brief records named, nested zones of every thread into per thread rings
+ * @detail a zone writes one event into the ring of its own thread when it
+ *         ends, so recording takes no lock. A ring keeps the latest events
+ *         and overwrites the oldest. Export between frames, while no zone is
+ *         being recorded, to get a consistent snapshot.
+ */
+class Profiler {
+public:
+    struct Event {
+        /* string literal, the name is not copied */
+        const char* name;
+        /* nanoseconds since the creation of the profiler */
+        int64_t begin;
+        int64_t end;
+        /* nesting level of the zone in its thread */
+        uint32_t depth;
+    };
+
+    struct ZoneSummary {
+        std::string name;
+        uint64_t count = 0;
+        /* milliseconds */
+        double total = 0.0;
+        double minimum = 0.0;
+        double maximum = 0.0;
+    };
+
+    /**
+     * @brief get the profiler of the process
+     */
+    static Profiler& get() {
+        static Profiler profiler;
+        return profiler;
+    }
+
+    Profiler(const Profiler&) = delete;
+
+    Profiler& operator=(const Profiler&) = delete;
+
+    /**
+     * @brief start or pause the recording of zones
+     */
+    void setEnabled(bool enabled) noexcept {
+        _enabled.store(enabled, std::memory_order_relaxed);
+    }
+
+    bool isEnabled() const noexcept {
+        return _enabled.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief set the ring size of threads recording for the first time
+     * @param capacity events per thread, rounded up to a power of 2
+     */
+    void setCapacity(size_t capacity) {
+        size_t roundedCapacity = 1;
+        while (roundedCapacity < capacity) {
+            roundedCapacity <<= 1;
+        }
+
+        _capacity.store(roundedCapacity, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief name the calling thread in the exported trace
+     */
+    void setThreadName(const std::string& name) {
+        ThreadBuffer* buffer = _getThreadBuffer();
+        std::lock_guard<std::mutex> lock(_mutex);
+        buffer->name = name;
+    }
+
+    /**
+     * @brief get the current time of the profiler clock in nanoseconds
+     */
+    int64_t now() const noexcept {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - _epoch).count();
+    }
+
+    /**
+     * @brief open a zone on the calling thread
+     * @return nesting level of the zone
+     */
+    uint32_t beginZone() {
+        return _getThreadBuffer()->depth++;
+    }
+
+    /**
+     * @brief close the innermost zone of the calling thread and record it
+     */
+    void endZone(const char* name, int64_t begin, uint32_t depth) {
+        ThreadBuffer* buffer = _getThreadBuffer();
+        --buffer->depth;
+
+        const uint64_t head = buffer->head.load(std::memory_order_relaxed);
+        buffer->events[head & (buffer->events.size() - 1)] = Event{ name, begin, now(), depth };
+        buffer->head.store(head + 1, std::memory_order_release);
+    }
+
+    /**
+     * @brief drop all recorded events
+     */
+    void clear() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (auto& buffer : _threadBuffers) {
+            buffer->tail = buffer->head.load(std::memory_order_acquire);
+        }
+    }
+
+    /**
+     * @brief write the recorded events as chrome trace json
+     * @detail the file opens in chrome://tracing and ui.perfetto.dev
+     * @return true on success
+     */
+    bool exportChromeTrace(const std::string& filepath) {
+        std::ofstream file(filepath);
+        if (!file) {
+            return false;
+        }
+
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+        bool first = true;
+        for (const auto& buffer : _threadBuffers) {
+            file << (first ? "" : ",\n")
+                << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->id
+                << ",\"args\":{\"name\":\"" << _escape(buffer->name) << "\"}}";
+            first = false;
+
+            _forEachEvent(*buffer, [&file, &buffer](const Event& event) {
+                file << std::fixed << std::setprecision(3)
+                    << ",\n{\"name\":\"" << _escape(event.name)
+                    << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->id
+                    << ",\"ts\":" << event.begin / 1000.0
+                    << ",\"dur\":" << (event.end - event.begin) / 1000.0 << "}";
+            });
+        }
+
+        file << "\n]}\n";
+
+        return static_cast<bool>(file);
+    }
+
+    /**
+     * @brief get the count and duration of the recorded events per zone name
+     */
+    std::vector<ZoneSummary> getSummary() {
+        std::map<std::string, ZoneSummary> zones;
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (const auto& buffer : _threadBuffers) {
+            _forEachEvent(*buffer, [&zones](const Event& event) {
+                const double duration = (event.end - event.begin) / 1e6;
+                ZoneSummary& zone = zones[event.name];
+                if (zone.count == 0) {
+                    zone.name = event.name;
+                    zone.minimum = zone.maximum = duration;
+                }
+
+                ++zone.count;
+                zone.total += duration;
+                zone.minimum = std::min(zone.minimum, duration);
+                zone.maximum = std::max(zone.maximum, duration);
+            });
+        }
+
+        std::vector<ZoneSummary> summary;
+        for (auto& zone : zones) {
+            summary.push_back(zone.second);
+        }
+
+        std::sort(summary.begin(), summary.end(), [](const ZoneSummary& a, const ZoneSummary& b) {
+            return a.total > b.total;
+        });
+
+        return summary;
+    }
+
+    /**
+     * @brief print the summary of the recorded events, heaviest zone first
+     */
+    void printSummary(std::ostream& out = std::cout) {
+        out << std::left << std::setw(24) << "zone"
+            << std::right << std::setw(10) << "count"
+            << std::setw(14) << "total ms"
+            << std::setw(12) << "mean ms"
+            << std::setw(12) << "min ms"
+            << std::setw(12) << "max ms" << "\n";
+
+        for (const auto& zone : getSummary()) {
+            out << std::left << std::setw(24) << zone.name
+                << std::right << std::setw(10) << zone.count
+                << std::fixed << std::setprecision(3)
+                << std::setw(14) << zone.total
+                << std::setw(12) << zone.total / zone.count
+                << std::setw(12) << zone.minimum
+                << std::setw(12) << zone.maximum << "\n";
+        }
+
+        out << std::flush;
+    }
+
+private:
+    struct ThreadBuffer {
+        uint32_t id = 0;
+        std::string name;
+        /* power of 2 sized ring, only written by the owner thread */
+        std::vector<Event> events;
+        /* events written, the ring holds [max(tail, head - size), head) */
+        std::atomic<uint64_t> head{ 0 };
+        uint64_t tail = 0;
+        uint32_t depth = 0;
+        /* false once the owner thread exits, the buffer is then reused */
+        bool active = true;
+    };
+
+    /**
+     * @brief hands the buffer back when its thread exits
+     */
+    struct ThreadBufferOwner {
+        ThreadBuffer* buffer = nullptr;
+
+        ~ThreadBufferOwner() {
+            if (buffer != nullptr) {
+                Profiler::get()._releaseThreadBuffer(buffer);
+            }
+        }
+    };
+
+    std::chrono::steady_clock::time_point _epoch = std::chrono::steady_clock::now();
+
+    std::atomic<bool> _enabled{ true };
+
+    std::atomic<size_t> _capacity{ 1 << 16 };
+
+    /* guards the buffer list and the thread names, never taken while recording */
+    std::mutex _mutex;
+
+    std::vector<std::unique_ptr<ThreadBuffer>> _threadBuffers;
+
+    Profiler() = default;
+
+    ThreadBuffer* _getThreadBuffer() {
+        thread_local ThreadBufferOwner owner;
+        if (owner.buffer == nullptr) {
+            owner.buffer = _acquireThreadBuffer();
+        }
+
+        return owner.buffer;
+    }
+
+    ThreadBuffer* _acquireThreadBuffer() {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        // threads that come and go, e.g. per frame workers, share the same tracks
+        for (auto& buffer : _threadBuffers) {
+            if (!buffer->active) {
+                buffer->active = true;
+                buffer->depth = 0;
+                return buffer.get();
+            }
+        }
+
+        auto buffer = std::make_unique<ThreadBuffer>();
+        buffer->id = static_cast<uint32_t>(_threadBuffers.size());
+        buffer->name = "thread " + std::to_string(buffer->id);
+        buffer->events.resize(_capacity.load(std::memory_order_relaxed));
+        _threadBuffers.push_back(std::move(buffer));
+
+        return _threadBuffers.back().get();
+    }
+
+    void _releaseThreadBuffer(ThreadBuffer* buffer) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        buffer->active = false;
+    }
+
+    template <typename Callback>
+    static void _forEachEvent(const ThreadBuffer& buffer, Callback&& callback) {
+        const uint64_t head = buffer.head.load(std::memory_order_acquire);
+        const uint64_t size = buffer.events.size();
+        const uint64_t first = std::max(buffer.tail, head > size ? head - size : 0);
+        for (uint64_t i = first; i < head; ++i) {
+            callback(buffer.events[i & (size - 1)]);
+        }
+    }
+
+    static std::string _escape(const std::string& text) {
+        std::string escaped;
+        for (char c : text) {
+            if (c == '"' || c == '\\') {
+                escaped += '\\';
+            }
+            escaped += c;
+        }
+
+        return escaped;
+    }
+};
+
+/**
+ * @brief records the enclosing scope as a zone of the calling thread
+ */
+class ProfileZone {
+public:
+    explicit ProfileZone(const char* name) noexcept : _name(name) {
+        Profiler& profiler = Profiler::get();
+        if (profiler.isEnabled()) {
+            _depth = profiler.beginZone();
+            _begin = profiler.now();
+            _recording = true;
+        }
+    }
+
+    ~ProfileZone() {
+        if (_recording) {
+            Profiler::get().endZone(_name, _begin, _depth);
+        }
+    }
+
+    ProfileZone(const ProfileZone&) = delete;
+
+    ProfileZone& operator=(const ProfileZone&) = delete;
+
+private:
+    const char* _name;
+    int64_t _begin = 0;
+    uint32_t _depth = 0;
+    bool _recording = false;
+};
+
+#define PROFILER_CONCAT_IMPL(a, b) a##b
+#define PROFILER_CONCAT(a, b) PROFILER_CONCAT_IMPL(a, b)
+
+/* name of the calling thread in the trace, its event buffer is only allocated when profiling */
+#ifdef ENABLE_PROFILER
+    #define PROFILE_THREAD_NAME(name) Profiler::get().setThreadName(name)
+#else
+    #define PROFILE_THREAD_NAME(name) ((void)0)
+#endif
+
+/* coarse zones, e.g. the stages of a frame */
+#ifdef ENABLE_PROFILER
+    #define PROFILE_ZONE(name) ProfileZone PROFILER_CONCAT(_profileZone, __LINE__)(name)
+#else
+    #define PROFILE_ZONE(name) ((void)0)
+#endif
+
+/* fine zones recorded per primitive, expensive enough to be enabled on their own */
+#if defined(ENABLE_PROFILER) && defined(ENABLE_PROFILER_DETAIL)
+    #define PROFILE_ZONE_DETAIL(name) ProfileZone PROFILER_CONCAT(_profileZone, __LINE__)(name)
+#else
+    #define PROFILE_ZONE_DETAIL(name) ((void)0)
+#endif
@@ -32,7 +32,10 @@ Model::Model(const std::string& filepath) {
 
 	_processNode(scene->mRootNode, scene);
 
-	_setupMeshes();
+	// headless hosts have no OpenGL context, the model is only used by cpu renderers
+	if (GLAD_GL_VERSION_3_3) {
+		_setupMeshes();
+	}
 }
 
 
@@ -41,7 +44,7 @@ Model::Model(const std::string& filepath) {
  */
 uint32_t Model::getVertexCount() const {
 	uint32_t count = 0;
-	for (const auto mesh : _meshes) {
+	for (const auto& mesh : _meshes) {
 		count += static_cast<uint32_t>(mesh.vertices.size());
 	}
 
@@ -54,7 +57,7 @@ uint32_t Model::getVertexCount() const {
  */
 uint32_t Model::getFaceCount() const {
 	uint32_t count = 0;
-	for (const auto mesh : _meshes) {
+	for (const auto& mesh : _meshes) {
 		count += static_cast<uint32_t>(mesh.indices.size());
 	}
 
@@ -63,20 +66,15 @@ uint32_t Model::getFaceCount() const {
 
 
 /*
- * @brief get all triangle faces in vertices - indices format
- * @param vertices of the triangle as output
- * @param vertex indices of the triangle face as output
+ * @brief get the bytes of the vertices and the indices of all meshes
  */
-void Model::getFaces(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices) const {
-	int offset = vertices.size();
+size_t Model::getMemoryBytes() const {
+	size_t bytes = 0;
 	for (const auto& mesh : _meshes) {
-		vertices.insert(vertices.end(), mesh.vertices.begin(), mesh.vertices.end());
-		for (int index : mesh.indices) {
-			indices.push_back(index + offset);
-		}
-
-		offset += mesh.vertices.size();
+		bytes += mesh.vertices.capacity() * sizeof(Vertex) + mesh.indices.capacity() * sizeof(uint32_t);
 	}
+
+	return bytes;
 }
 
 
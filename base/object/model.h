@@ -37,10 +37,31 @@ public:
      */
 	uint32_t getFaceCount() const;
 
+	/*
+	 * @brief get the bytes of the vertices and the indices of all meshes
+	 */
+	size_t getMemoryBytes() const;
+
 	/*
 	 * @brief get all triangle faces in vertices - indices format
+	 * @param vertices of the triangle as output
+	 * @param vertex indices of the triangle face as output
 	 */
-	void getFaces(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices) const;
+	template <typename VertexAllocator, typename IndexAllocator>
+	void getFaces(std::vector<Vertex, VertexAllocator>& vertices,
+		std::vector<uint32_t, IndexAllocator>& indices) const {
+		uint32_t offset = static_cast<uint32_t>(vertices.size());
+		vertices.reserve(vertices.size() + getVertexCount());
+		indices.reserve(indices.size() + 3 * static_cast<size_t>(getFaceCount()));
+		for (const auto& mesh : _meshes) {
+			vertices.insert(vertices.end(), mesh.vertices.begin(), mesh.vertices.end());
+			for (uint32_t index : mesh.indices) {
+				indices.push_back(index + offset);
+			}
+
+			offset += static_cast<uint32_t>(mesh.vertices.size());
+		}
+	}
 
 	/*
 	 * @brief get all triangles
@@ -0,0 +1,61 @@
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#include "allocation_counter.h"
+
+#ifndef NDEBUG
+
+namespace {
+	std::atomic<uint64_t> allocationCount{ 0 };
+}
+
+
+/*
+ * @brief the nothrow and array forms of new and the other forms of delete
+ *        forward to these by default
+ */
+void* operator new(std::size_t size) {
+	allocationCount.fetch_add(1, std::memory_order_relaxed);
+	if (void* data = std::malloc(size != 0 ? size : 1)) {
+		return data;
+	}
+
+	throw std::bad_alloc();
+}
+
+
+void operator delete(void* data) noexcept {
+	std::free(data);
+}
+
+
+/*
+ * @brief replaced with the unsized form, the pair has to match
+ */
+void operator delete(void* data, std::size_t) noexcept {
+	operator delete(data);
+}
+
+
+bool AllocationCounter::isEnabled() {
+	return true;
+}
+
+
+uint64_t AllocationCounter::getCount() {
+	return allocationCount.load(std::memory_order_relaxed);
+}
+
+#else
+
+bool AllocationCounter::isEnabled() {
+	return false;
+}
+
+
+uint64_t AllocationCounter::getCount() {
+	return 0;
+}
+
+#endif
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstdint>
+
+/*
+ * @brief counts the heap allocations of the whole process in debug builds
+ * @detail allocation_counter.cpp replaces the global operator new unless
+ *         NDEBUG is defined, release builds keep the default allocator.
+ *         Allocations of every thread count, e.g. of a frame writer.
+ */
+class AllocationCounter {
+public:
+	/*
+	 * @brief check if the allocations are counted in this build
+	 */
+	static bool isEnabled();
+
+	/*
+	 * @brief get the allocations since the start of the process, 0 if not counted
+	 */
+	static uint64_t getCount();
+};
@@ -1,6 +1,8 @@
 //#define SHOW_CALLBACK
 //#define SHOW_RENDER_INFO
 
+#include <cstdio>
+
 #include "application.h"
 
 /*
@@ -50,7 +52,7 @@ Application::Application() {
 	//_models[0].rotate(glm::vec3(0.0f, glm::radians(60.0f), 0.0f), Object3D::RotateOrder::ZYX);
 	//_models[0].rotate(glm::vec3(0.0f, 0.0f, glm::radians(60.0f)), Object3D::RotateOrder::ZYX);
 
-	_framebuffer = new Framebuffer(_windowWidth, _windowHeight);
+	_framebuffer = new GlFramebuffer(_windowWidth, _windowHeight);
 
 	std::vector<Vertex> _vertices;
 	std::vector<uint32_t> _indices;
@@ -63,9 +65,30 @@ Application::Application() {
 			_vertices[_indices[i]], _vertices[_indices[i + 1]] , _vertices[_indices[i + 2]] });
 	}
 
+	size_t meshBytes = _triangles.capacity() * sizeof(Triangle);
+	for (const auto& model : _models) {
+		meshBytes += model.getMemoryBytes();
+	}
+	_meshMemory.resize(meshBytes);
+
 	_scanlineRenderer = new ScanlineRenderer(*_framebuffer, _windowWidth, _windowHeight, _triangles, _clearColor);
 
+	// series 0 is the gpu renderer, series 1 + i the render mode i
+	std::vector<std::string> seriesNames = { "gpu" };
+	for (auto renderMode : {
+		ScanlineRenderer::RenderMode::Global,
+		ScanlineRenderer::RenderMode::ZBuffer,
+		ScanlineRenderer::RenderMode::HierarchicalZBuffer,
+		ScanlineRenderer::RenderMode::OctreeHierarchicalZBuffer,
+		ScanlineRenderer::RenderMode::VisibilityBuffer,
+		ScanlineRenderer::RenderMode::Cluster,
+		ScanlineRenderer::RenderMode::Instanced }) {
+		seriesNames.push_back(ScanlineRenderer::getRenderModeName(renderMode));
+	}
+	_frameStatistics = new FrameStatistics(seriesNames, _frameStatisticsWindowSize);
+
 	_lastTimeStamp = std::chrono::high_resolution_clock::now();
+	_lastTitleUpdate = _lastTimeStamp;
 }
 
 
@@ -73,6 +96,11 @@ Application::Application() {
  * @brief default destructor
  */
 Application::~Application() {
+	if (_frameStatistics != nullptr) {
+		delete _frameStatistics;
+		_frameStatistics = nullptr;
+	}
+
 	if (_framebuffer != nullptr) {
 		delete _framebuffer;
 		_framebuffer = nullptr;
@@ -103,6 +131,8 @@ void Application::run() {
 		glfwSwapBuffers(_window);
 		glfwPollEvents();
 	}
+
+	_exportFrameStatistics();
 }
 
 
@@ -242,7 +272,56 @@ void Application::_handleInput() {
 	} else if (_keyboardInput.keyPressed[GLFW_KEY_4]) {
 		_rendererType = RendererType::ScanLineRenderer;
 		_scanlineRenderer->setRenderMode(ScanlineRenderer::RenderMode::OctreeHierarchicalZBuffer);
+	} else if (_keyboardInput.keyPressed[GLFW_KEY_5]) {
+		_rendererType = RendererType::ScanLineRenderer;
+		_scanlineRenderer->setRenderMode(ScanlineRenderer::RenderMode::VisibilityBuffer);
+	} else if (_keyboardInput.keyPressed[GLFW_KEY_6]) {
+		_rendererType = RendererType::ScanLineRenderer;
+		_scanlineRenderer->setRenderMode(ScanlineRenderer::RenderMode::Cluster);
+	} else if (_keyboardInput.keyPressed[GLFW_KEY_7]) {
+		_rendererType = RendererType::ScanLineRenderer;
+		_scanlineRenderer->setRenderMode(ScanlineRenderer::RenderMode::Instanced);
+		// one instance per model with the identity transform, the other modes
+		// render the vertices as loaded as well
+		if (_instances.empty()) {
+			_geometries.reserve(_models.size());
+			for (const auto& model : _models) {
+				_geometries.emplace_back(model);
+				_instances.emplace_back(&_geometries.back());
+			}
+			_scanlineRenderer->setInstances(&_instances);
+		}
+	}
+
+	// export once per key press, not once per frame while the key is held
+	if (_keyboardInput.keyPressed[GLFW_KEY_P] && !_exportKeyDown) {
+		_exportFrameStatistics();
 	}
+	_exportKeyDown = _keyboardInput.keyPressed[GLFW_KEY_P];
+
+	if (_keyboardInput.keyPressed[GLFW_KEY_M] && !_memoryKeyDown) {
+		MemoryTracker::get().printSummary();
+	}
+	_memoryKeyDown = _keyboardInput.keyPressed[GLFW_KEY_M];
+
+	if (_keyboardInput.keyPressed[GLFW_KEY_O] && !_depthSortingKeyDown) {
+		_scanlineRenderer->setDepthSorting(!_scanlineRenderer->isDepthSorting());
+	}
+	_depthSortingKeyDown = _keyboardInput.keyPressed[GLFW_KEY_O];
+
+	if (_keyboardInput.keyPressed[GLFW_KEY_L] && !_lodKeyDown) {
+		if (_scanlineRenderer->getLodChains() != nullptr) {
+			_scanlineRenderer->setLodChains(nullptr);
+		} else {
+			if (_lodChains.empty()) {
+				for (const auto& model : _models) {
+					_lodChains.emplace_back(model);
+				}
+			}
+			_scanlineRenderer->setLodChains(&_lodChains);
+		}
+	}
+	_lodKeyDown = _keyboardInput.keyPressed[GLFW_KEY_L];
 
 	_mouseInput.move.xOld = _mouseInput.move.xCurrent;
 	_mouseInput.move.yOld = _mouseInput.move.yCurrent;
@@ -265,36 +344,107 @@ void Application::_renderFrame() {
 
 	auto stop = std::chrono::high_resolution_clock::now();
 	auto milliseconds = std::chrono::duration<double, std::milli>(stop - start).count();
-
-	if (_rendererType == RendererType::GpuRenderer) {
-		_windowTitle = "gpu renderer";
-	} else {
-		switch (_scanlineRenderer->getRenderMode()) {
-		case ScanlineRenderer::RenderMode::Global:
-			_windowTitle = "scanline renderer global with zbuffer";
-			break;
-		case ScanlineRenderer::RenderMode::ZBuffer:
-			_windowTitle = "scanline renderer local with zbuffer";
-			break;
-		case ScanlineRenderer::RenderMode::HierarchicalZBuffer:
-			_windowTitle = "scanline renderer local with hierarchical zbuffer";
-			break;
-		case ScanlineRenderer::RenderMode::OctreeHierarchicalZBuffer:
-			_windowTitle = "scanline renderer local with octree and hierarchical zBuffer";
-			break;
-		}
+	_frameStatistics->record(_getFrameSeries(), milliseconds);
+
+	if (std::chrono::duration<double>(stop - _lastTitleUpdate).count() >= _titleUpdateInterval) {
+		const FrameStatistics::Summary summary = _frameStatistics->getSummary(_getFrameSeries());
+		char title[256];
+		std::snprintf(title, sizeof(title),
+			"%s  render time: p50 %.2fms  p95 %.2fms  p99 %.2fms  max %.2fms (%d frames)",
+			_getRendererTitle(), summary.p50, summary.p95, summary.p99, summary.maximum, summary.count);
+		_windowTitle.assign(title);
+		glfwSetWindowTitle(_window, _windowTitle.c_str());
+		_lastTitleUpdate = stop;
 	}
 
-	_windowTitle += "  render time: " + std::to_string(milliseconds) + "ms";
-	glfwSetWindowTitle(_window, _windowTitle.c_str());
-
 
 #ifdef SHOW_RENDER_INFO
 	std::cout << "+ render time: " << milliseconds << " ms" << std::endl;
+	if (_rendererType == RendererType::ScanLineRenderer) {
+		const Culler::Statistics& cullStatistics = _scanlineRenderer->getCullStatistics();
+		std::cout << "+ culled: " << cullStatistics.backFace << " back-face, "
+			<< cullStatistics.zeroArea << " zero area, "
+			<< cullStatistics.subPixel << " sub pixel of "
+			<< cullStatistics.submitted << " triangles, "
+			<< _scanlineRenderer->getOccludedCount() << " occluded, "
+			<< _scanlineRenderer->getSubmittedTriangleCount() << " submitted" << std::endl;
+		const ClusterSet::Statistics& clusterStatistics = _scanlineRenderer->getClusterStatistics();
+		if (clusterStatistics.submitted > 0) {
+			std::cout << "+ clusters culled: " << clusterStatistics.frustum << " frustum, "
+				<< clusterStatistics.backFace << " back-face, "
+				<< clusterStatistics.occluded << " occluded of "
+				<< clusterStatistics.submitted << " clusters" << std::endl;
+		}
+		const Octree::Statistics& octreeStatistics = _scanlineRenderer->getOctreeStatistics();
+		if (octreeStatistics.visited > 0) {
+			std::cout << "+ octree nodes culled: " << octreeStatistics.frustum << " frustum, "
+				<< octreeStatistics.occluded << " occluded, "
+				<< octreeStatistics.inside << " inside of the frustum of "
+				<< octreeStatistics.visited << " nodes" << std::endl;
+		}
+#ifdef ENABLE_OVERDRAW_STATISTICS
+		OverdrawCounters::print(_scanlineRenderer->getOverdrawCounters().getStatistics());
+#endif
+	}
 #endif
 }
 
 
+/*
+ * @brief get the frame statistics series of the current renderer
+ */
+int Application::_getFrameSeries() const {
+	if (_rendererType == RendererType::GpuRenderer) {
+		return 0;
+	}
+
+	return 1 + static_cast<int>(_scanlineRenderer->getRenderMode());
+}
+
+
+/*
+ * @brief get the description of the current renderer
+ */
+const char* Application::_getRendererTitle() const {
+	if (_rendererType == RendererType::GpuRenderer) {
+		return "gpu renderer";
+	}
+
+	switch (_scanlineRenderer->getRenderMode()) {
+	case ScanlineRenderer::RenderMode::Global:
+		return "scanline renderer global with zbuffer";
+	case ScanlineRenderer::RenderMode::ZBuffer:
+		return "scanline renderer local with zbuffer";
+	case ScanlineRenderer::RenderMode::HierarchicalZBuffer:
+		return "scanline renderer local with hierarchical zbuffer";
+	case ScanlineRenderer::RenderMode::OctreeHierarchicalZBuffer:
+		return "scanline renderer local with octree and hierarchical zBuffer";
+	case ScanlineRenderer::RenderMode::VisibilityBuffer:
+		return "scanline renderer local with visibility buffer";
+	case ScanlineRenderer::RenderMode::Cluster:
+		return "scanline renderer local with clusters and hierarchical zbuffer";
+	case ScanlineRenderer::RenderMode::Instanced:
+		return "scanline renderer local with instances and hierarchical zbuffer";
+	}
+
+	return "scanline renderer";
+}
+
+
+/*
+ * @brief write the frame statistics as csv and json
+ */
+void Application::_exportFrameStatistics() const {
+	const std::string csvFilepath = _frameStatisticsFilepath + ".csv";
+	const std::string jsonFilepath = _frameStatisticsFilepath + ".json";
+	if (_frameStatistics->exportCsv(csvFilepath) && _frameStatistics->exportJson(jsonFilepath)) {
+		std::cout << "frame statistics written to " << csvFilepath << " and " << jsonFilepath << std::endl;
+	} else {
+		std::cerr << "write frame statistics " << _frameStatisticsFilepath << " failure" << std::endl;
+	}
+}
+
+
 void Application::_renderWithGpu() {
 	glEnable(GL_DEPTH_TEST);
 	glClearColor(_clearColor[0], _clearColor[1], _clearColor[2], _clearColor[3]);
@@ -11,16 +11,21 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 
+#include "core/memory_tracker.h"
+
 #include "fps_camera.h"
 #include "input.h"
 #include "model.h"
 #include "quadtree.h"
 #include "octree.h"
 #include "framebuffer.h"
+#include "gl_framebuffer.h"
 #include "zbuffer.h"
 #include "quadtree.h"
 #include "clipper.h"
+#include "lod_chain.h"
 #include "scanline_renderer.h"
+#include "frame_statistics.h"
 
 
 class Application {
@@ -66,6 +71,9 @@ private:
 	/* triangle data: local space */
 	std::vector<Triangle> _triangles;
 
+	/* the models and the triangles */
+	MemoryRegistration _meshMemory{ MemoryTag::Meshes };
+
 	/* camera */
 	FpsCamera _fpsCamera{glm::radians(54.0f), 1.0f * _windowWidth / _windowHeight, 1.0f, 500.0f };
 
@@ -94,6 +102,30 @@ private:
 	/* renderer */
 	ScanlineRenderer* _scanlineRenderer = nullptr;
 
+	/* frame times, one series per renderer and render mode */
+	FrameStatistics* _frameStatistics = nullptr;
+	int _frameStatisticsWindowSize = 600;
+	/* exported as <path>.csv and <path>.json on key P and at exit */
+	std::string _frameStatisticsFilepath = "frame_statistics";
+	bool _exportKeyDown = false;
+
+	/* the memory per subsystem is printed on key M */
+	bool _memoryKeyDown = false;
+
+	/* the front to back triangle order is toggled on key O */
+	bool _depthSortingKeyDown = false;
+
+	/* geometry per model shared by its instances, built when the instanced mode is first selected */
+	std::vector<Geometry> _geometries;
+	std::vector<Instance> _instances;
+
+	/* levels of detail per model, built on the first press of key L, which toggles them */
+	std::vector<LodChain> _lodChains;
+	bool _lodKeyDown = false;
+
+	/* the window title shows the statistics, refreshed a few times a second */
+	std::chrono::time_point<std::chrono::high_resolution_clock> _lastTitleUpdate;
+	double _titleUpdateInterval = 0.25;
 
 	/*
 	 * @brief load models from model path
@@ -133,4 +165,19 @@ private:
 	 * @brief render frame with gpu
 	 */
 	void _renderWithGpu();
+
+	/*
+	 * @brief get the frame statistics series of the current renderer
+	 */
+	int _getFrameSeries() const;
+
+	/*
+	 * @brief get the description of the current renderer
+	 */
+	const char* _getRendererTitle() const;
+
+	/*
+	 * @brief write the frame statistics as csv and json
+	 */
+	void _exportFrameStatistics() const;
 };
\ No newline at end of file
@@ -0,0 +1,857 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+#include "core/job_system.h"
+#include "core/profiler.h"
+#include "allocation_counter.h"
+#include "benchmark.h"
+
+
+/*
+ * @brief parse the command line options of the benchmark
+ * @exception std::invalid_argument for an unknown or incomplete option
+ */
+Benchmark::Options Benchmark::parseOptions(int argc, char* argv[]) {
+	Options options;
+	bool modeGiven = false;
+
+	for (int i = 0; i < argc; ++i) {
+		const std::string option = argv[i];
+		if (option == "--perf") {
+			options.perfCounters = true;
+			continue;
+		} else if (option == "--pin") {
+			options.pinThreads = true;
+			continue;
+		} else if (option == "--sort") {
+			options.depthSorting = true;
+			continue;
+		} else if (option == "--animate") {
+			options.animate = true;
+			continue;
+		}
+
+		if (i + 1 >= argc) {
+			throw std::invalid_argument("missing value of option " + option);
+		}
+
+		const std::string value = argv[++i];
+		if (option == "--width") {
+			options.width = std::stoi(value);
+		} else if (option == "--height") {
+			options.height = std::stoi(value);
+		} else if (option == "--frames") {
+			options.frameCount = std::stoi(value);
+		} else if (option == "--model") {
+			options.modelFilepaths.push_back(value);
+		} else if (option == "--mode") {
+			if (!modeGiven) {
+				options.renderModes.clear();
+				modeGiven = true;
+			}
+
+			bool found = false;
+			for (auto renderMode : Options().renderModes) {
+				if (value == ScanlineRenderer::getRenderModeName(renderMode)) {
+					options.renderModes.push_back(renderMode);
+					found = true;
+				}
+			}
+
+			if (!found) {
+				throw std::invalid_argument("unknown render mode " + value);
+			}
+		} else if (option == "--dump") {
+			options.dumpDirectory = value;
+		} else if (option == "--format") {
+			options.dumpFormat = FrameWriter::parseFormat(value);
+		} else if (option == "--heatmap") {
+#ifdef ENABLE_OVERDRAW_STATISTICS
+			options.heatmapDirectory = value;
+#else
+			throw std::invalid_argument("--heatmap needs a build with ENABLE_OVERDRAW_STATISTICS");
+#endif
+		} else if (option == "--trace") {
+#ifdef ENABLE_PROFILER
+			options.traceDirectory = value;
+#else
+			throw std::invalid_argument("--trace needs a build with ENABLE_PROFILER");
+#endif
+		} else if (option == "--workers") {
+			options.workerCount = std::stoi(value);
+		} else if (option == "--lod") {
+			options.lodPixelError = std::stof(value);
+		} else if (option == "--orbit") {
+			options.orbitRadius = std::stof(value);
+		} else if (option == "--splat") {
+			options.splatSize = std::stof(value);
+		} else if (option == "--pvs") {
+			options.visibleSetFilepath = value;
+		} else if (option == "--pvs-cells") {
+			options.visibleSetCellCount = std::max(std::stoi(value), 1);
+		} else if (option == "--deform") {
+			options.deformShare = glm::clamp(std::stof(value), 0.0f, 1.0f);
+		} else if (option == "--instances") {
+			options.instanceCount = std::max(std::stoi(value), 1);
+		} else if (option == "--scene") {
+			options.scene.layout = SceneGenerator::parseLayout(value);
+			options.generateScene = true;
+		} else if (option == "--triangles") {
+			options.scene.triangleCount = static_cast<uint64_t>(std::stod(value));
+		} else if (option == "--depth") {
+			options.scene.depthComplexity = std::stoi(value);
+		} else if (option == "--occlusion") {
+			options.scene.occlusionRatio = std::stof(value);
+		} else if (option == "--seed") {
+			options.scene.seed = static_cast<uint32_t>(std::stoul(value));
+		} else if (option == "--flatten") {
+			options.flattenLimit = static_cast<uint64_t>(std::stod(value));
+		} else if (option == "--sweep") {
+			const size_t separator = value.find('=');
+			options.sweepParameter = value.substr(0, separator);
+			if (separator == std::string::npos || (options.sweepParameter != "triangles" &&
+				options.sweepParameter != "depth" && options.sweepParameter != "occlusion")) {
+				throw std::invalid_argument("unknown sweep " + value);
+			}
+
+			std::stringstream values(value.substr(separator + 1));
+			std::string item;
+			while (std::getline(values, item, ',')) {
+				options.sweepValues.push_back(std::stod(item));
+			}
+		} else if (option == "--stats") {
+			options.statisticsFilepath = value;
+		} else if (option == "--shm") {
+			options.sharedMemoryName = value;
+		} else if (option == "--shm-slots") {
+			options.sharedMemorySlotCount = std::stoi(value);
+		} else if (option == "--shm-policy") {
+			if (value == "drop") {
+				options.sharedMemoryPolicy = SharedFrameRing::Policy::DropOldest;
+			} else if (value == "block") {
+				options.sharedMemoryPolicy = SharedFrameRing::Policy::Block;
+			} else {
+				throw std::invalid_argument("unknown shared memory policy " + value);
+			}
+		} else {
+			throw std::invalid_argument("unknown option " + option);
+		}
+	}
+
+	// render() hands the shared pixels over, there is nothing left to dump
+	if (!options.sharedMemoryName.empty() && !options.dumpDirectory.empty()) {
+		throw std::invalid_argument("--dump and --shm cannot be used together");
+	}
+
+	if (!options.sweepValues.empty() && !options.generateScene) {
+		throw std::invalid_argument("--sweep needs --scene");
+	}
+
+	// the scene places its own instances, the levels of detail replace the models only
+	if (options.generateScene && options.instanceCount > 1) {
+		throw std::invalid_argument("--instances and --scene cannot be used together");
+	}
+
+	if (options.generateScene && options.lodPixelError > 0.0f) {
+		throw std::invalid_argument("--lod and --scene cannot be used together");
+	}
+
+	// the counters follow the calling thread only, the stages must not run on the workers
+	if (options.perfCounters) {
+		if (options.workerCount > 0) {
+			throw std::invalid_argument("--perf counts the calling thread only, use --workers 0");
+		}
+		options.workerCount = 0;
+	}
+
+	if (options.modelFilepaths.empty()) {
+		options.modelFilepaths.push_back("../resources/bunny.obj");
+	}
+
+	return options;
+}
+
+
+/*
+ * @brief print the command line options of the benchmark
+ */
+void Benchmark::printUsage() {
+	std::cout << "usage: hierarchical_zbuffer --benchmark [options]\n"
+		<< "  --width <pixels>        image width, 1280 by default\n"
+		<< "  --height <pixels>       image height, 720 by default\n"
+		<< "  --frames <count>        frames per render mode, 100 by default\n"
+		<< "  --model <path>          model to load, repeatable\n"
+		<< "  --mode <name>           global, zbuffer, hzb, octree, visibility, cluster or\n"
+		<< "                          instanced, repeatable\n"
+		<< "  --dump <directory>      write every frame to the directory\n"
+		<< "  --format <name>         ppm, png or raw, ppm by default\n"
+		<< "  --heatmap <directory>   write overdraw heatmaps, needs ENABLE_OVERDRAW_STATISTICS\n"
+		<< "  --stats <file>          export the frame statistics, json or csv by extension\n"
+		<< "  --perf                  count cycles, instructions and misses per render stage, without workers\n"
+		<< "  --workers <count>       worker threads, one per hardware thread by default\n"
+		<< "  --pin                   bind the worker threads to hardware threads\n"
+		<< "  --sort                  submit the triangles front to back in the hzb and visibility modes,\n"
+		<< "                          the clusters in the cluster mode\n"
+		<< "  --lod <pixels>          select a level of detail per model in the zbuffer, hzb and\n"
+		<< "                          visibility modes with at most this projected error\n"
+		<< "  --orbit <radius>        distance of the camera from the origin, 10 or just outside of\n"
+		<< "                          the scene by default\n"
+		<< "  --splat <pixels>        draw the octree nodes up to this size on the screen as one splat\n"
+		<< "                          in the octree and instanced modes\n"
+		<< "  --pvs <file>            skip the octree nodes the camera cell cannot see in the octree mode,\n"
+		<< "                          the set is built around the orbit and written if the file is missing\n"
+		<< "  --pvs-cells <count>     cells of the potentially visible set along x and z, 8 by default\n"
+		<< "  --instances <count>     instances per model on a grid in the instanced mode, 1 by default\n"
+		<< "  --animate               move every fourth instance up and down in the instanced mode\n"
+		<< "  --deform <share>        move this share of the triangles of the first model every frame\n"
+		<< "                          in the instanced mode, the octree refits their nodes only\n"
+		<< "  --scene <layout>        render instances of the models laid out as grid, city, corridor\n"
+		<< "                          or clutter, not in the global mode\n"
+		<< "  --triangles <count>     triangles of the scene, 1e6 by default\n"
+		<< "  --depth <cells>         cells of the scene a view ray crosses, 8 by default\n"
+		<< "  --occlusion <ratio>     share of the cells of the scene with an occluder, 0.25 by default\n"
+		<< "  --seed <number>         seed of the scene, 1 by default\n"
+		<< "  --flatten <triangles>   largest scene rendered by the modes without instancing, 4e6 by default\n"
+		<< "  --sweep <option>=<list> run once per comma separated value of triangles, depth or\n"
+		<< "                          occlusion, --stats exports the table of all runs as csv\n"
+		<< "  --trace <directory>     write a chrome trace and a zone summary per mode,\n"
+		<< "                          needs ENABLE_PROFILER\n"
+		<< "  --shm <name>            render into a shared memory frame ring\n"
+		<< "  --shm-slots <count>     frames in the ring, 3 by default\n"
+		<< "  --shm-policy <name>     drop or block when the ring is full, drop by default" << std::endl;
+}
+
+
+/*
+ * @brief constructor, load the models and build the renderer
+ */
+Benchmark::Benchmark(const Options& options)
+	: _options(options),
+	_camera(glm::radians(54.0f), 1.0f * options.width / options.height, 1.0f, 500.0f) {
+	JobSystem::Options jobSystemOptions;
+	jobSystemOptions.workerCount = _options.workerCount;
+	jobSystemOptions.pinThreads = _options.pinThreads;
+	JobSystem::setDefaultOptions(jobSystemOptions);
+
+	for (const auto& filepath : _options.modelFilepaths) {
+		std::cout << "loading " + filepath + "..." << std::endl;
+		_models.push_back(Model(filepath));
+	}
+
+	std::vector<Vertex> vertices;
+	std::vector<uint32_t> indices;
+	for (const auto& model : _models) {
+		model.getFaces(vertices, indices);
+	}
+
+	for (size_t i = 0; i < indices.size(); i += 3) {
+		_triangles.push_back({
+			vertices[indices[i]], vertices[indices[i + 1]] , vertices[indices[i + 2]] });
+	}
+
+	if (_options.generateScene) {
+		_createScene();
+	}
+
+	if (_options.orbitRadius <= 0.0f) {
+		_options.orbitRadius = _scene != nullptr ? _scene->getRadius() + _scene->getCellSize() : 10.0f;
+	}
+
+	if (_scene != nullptr) {
+		_camera.setFarClip(std::max(_camera.getFarClip(), _options.orbitRadius + _scene->getRadius()));
+	}
+
+	std::cout << "+ faces:    " << _triangles.size() << std::endl;
+
+	size_t meshBytes = _triangles.capacity() * sizeof(Triangle);
+	for (const auto& model : _models) {
+		meshBytes += model.getMemoryBytes();
+	}
+	_meshMemory.resize(meshBytes);
+
+	if (!_options.sharedMemoryName.empty()) {
+		_framebuffer = new SharedFramebuffer(_options.sharedMemoryName, _options.width, _options.height,
+			_options.sharedMemorySlotCount, _options.sharedMemoryPolicy);
+	} else {
+		_framebuffer = new Framebuffer(_options.width, _options.height);
+	}
+	_scanlineRenderer = new ScanlineRenderer(*_framebuffer,
+		_options.width, _options.height, _triangles, _clearColor);
+	_scanlineRenderer->setDepthSorting(_options.depthSorting);
+	_scanlineRenderer->setSplatSize(_options.splatSize);
+
+	if (_options.lodPixelError > 0.0f) {
+		for (const auto& model : _models) {
+			_lodChains.emplace_back(model);
+			std::cout << "+ levels:  ";
+			for (int i = 0; i < _lodChains.back().getLevelCount(); ++i) {
+				const auto& level = _lodChains.back().getLevel(i);
+				std::cout << " " << level.triangles.size() << " (" << level.error << ")";
+			}
+			std::cout << std::endl;
+		}
+		_scanlineRenderer->setLodChains(&_lodChains);
+		_scanlineRenderer->setLodPixelError(_options.lodPixelError);
+	}
+
+	if (!_options.visibleSetFilepath.empty()) {
+		_createVisibleSet();
+	}
+
+	if (_scene != nullptr) {
+		_scanlineRenderer->setInstances(&_scene->getInstances());
+	} else if (std::find(_options.renderModes.begin(), _options.renderModes.end(),
+		ScanlineRenderer::RenderMode::Instanced) != _options.renderModes.end()) {
+		_createInstances();
+		_scanlineRenderer->setInstances(&_instances);
+	}
+
+	std::vector<std::string> seriesNames;
+	for (auto renderMode : _options.renderModes) {
+		seriesNames.push_back(ScanlineRenderer::getRenderModeName(renderMode));
+	}
+	_frameStatistics = new FrameStatistics(seriesNames, std::max(_options.frameCount, 1));
+
+	if (_options.perfCounters) {
+		_perfStages = new PerfStages();
+		if (!_perfStages->getCounters().isAvailable()) {
+			std::cerr << "hardware counters unavailable, " << _perfStages->getCounters().getError() << std::endl;
+		}
+		_scanlineRenderer->setPerfStages(_perfStages);
+	}
+
+	if (!_options.dumpDirectory.empty()) {
+		_frameWriter = new FrameWriter(_options.dumpDirectory, _options.dumpFormat,
+			_options.width, _options.height);
+	}
+}
+
+
+/*
+ * @brief default destructor
+ */
+Benchmark::~Benchmark() {
+	if (_perfStages != nullptr) {
+		delete _perfStages;
+		_perfStages = nullptr;
+	}
+
+	if (_frameStatistics != nullptr) {
+		delete _frameStatistics;
+		_frameStatistics = nullptr;
+	}
+
+	if (_frameWriter != nullptr) {
+		delete _frameWriter;
+		_frameWriter = nullptr;
+	}
+
+	if (_scanlineRenderer != nullptr) {
+		delete _scanlineRenderer;
+		_scanlineRenderer = nullptr;
+	}
+
+	if (_framebuffer != nullptr) {
+		delete _framebuffer;
+		_framebuffer = nullptr;
+	}
+
+	if (_scene != nullptr) {
+		delete _scene;
+		_scene = nullptr;
+	}
+}
+
+
+/*
+ * @brief render all frames of all render modes and print the timings
+ */
+void Benchmark::run() {
+	PROFILE_THREAD_NAME("main");
+
+	_results.clear();
+
+	uint64_t frameIndex = 0;
+	for (int series = 0; series < static_cast<int>(_options.renderModes.size()); ++series) {
+		const auto renderMode = _options.renderModes[series];
+		_scanlineRenderer->setRenderMode(renderMode);
+
+		uint64_t occludedTotal = 0;
+		uint64_t acceptedTotal = 0;
+		uint64_t submittedTotal = 0;
+		ClusterSet::Statistics clusterTotal;
+		Octree::Statistics octreeTotal;
+		Instance::Statistics instanceTotal;
+		double deformTotal = 0.0;
+#ifdef ENABLE_OVERDRAW_STATISTICS
+		OverdrawCounters::Statistics overdrawTotal;
+#endif
+		for (int frame = 0; frame < _options.frameCount; ++frame) {
+			_updateCamera(frame);
+			if (_options.animate && renderMode == ScanlineRenderer::RenderMode::Instanced) {
+				_animateInstances(frame);
+			}
+			if (_options.deformShare > 0.0f && renderMode == ScanlineRenderer::RenderMode::Instanced) {
+				deformTotal += _deformGeometry(frame);
+			}
+
+			auto start = std::chrono::high_resolution_clock::now();
+			_scanlineRenderer->render(*_framebuffer,
+				_camera, _models, _objectColor, _lightColor, _lightDirection);
+			auto stop = std::chrono::high_resolution_clock::now();
+
+			_frameStatistics->record(series,
+				std::chrono::duration<double, std::milli>(stop - start).count());
+			occludedTotal += _scanlineRenderer->getOccludedCount();
+			acceptedTotal += _scanlineRenderer->getAcceptedCount();
+			submittedTotal += _scanlineRenderer->getSubmittedTriangleCount();
+
+			const ClusterSet::Statistics& clusters = _scanlineRenderer->getClusterStatistics();
+			clusterTotal.submitted += clusters.submitted;
+			clusterTotal.frustum += clusters.frustum;
+			clusterTotal.backFace += clusters.backFace;
+			clusterTotal.occluded += clusters.occluded;
+
+			const Octree::Statistics& octree = _scanlineRenderer->getOctreeStatistics();
+			octreeTotal.visited += octree.visited;
+			octreeTotal.frustum += octree.frustum;
+			octreeTotal.inside += octree.inside;
+			octreeTotal.occluded += octree.occluded;
+			octreeTotal.potentiallyVisible += octree.potentiallyVisible;
+			octreeTotal.covered += octree.covered;
+			octreeTotal.splatted += octree.splatted;
+
+			const Instance::Statistics& instances = _scanlineRenderer->getInstanceStatistics();
+			instanceTotal.submitted += instances.submitted;
+			instanceTotal.frustum += instances.frustum;
+			instanceTotal.occluded += instances.occluded;
+
+#ifdef ENABLE_OVERDRAW_STATISTICS
+			const auto overdraw = _scanlineRenderer->getOverdrawCounters().getStatistics();
+			overdrawTotal.tests += overdraw.tests;
+			overdrawTotal.passes += overdraw.passes;
+			overdrawTotal.writes += overdraw.writes;
+			overdrawTotal.coveredPixels += overdraw.coveredPixels;
+			for (int i = 0; i < OverdrawCounters::Statistics::binCount; ++i) {
+				overdrawTotal.testHistogram[i] += overdraw.testHistogram[i];
+				overdrawTotal.writeHistogram[i] += overdraw.writeHistogram[i];
+			}
+#endif
+
+			// encoding overlaps the rasterization of the next frame
+			if (_frameWriter != nullptr) {
+				_frameWriter->submit(*_framebuffer, frameIndex);
+			}
+
+			++frameIndex;
+		}
+
+		const FrameStatistics::Summary summary = _frameStatistics->getSummary(series);
+		std::cout << ScanlineRenderer::getRenderModeName(renderMode) << ": "
+			<< summary.count << " frames, render time"
+			<< " mean " << summary.mean << " ms"
+			<< " min " << summary.minimum << " ms"
+			<< " p50 " << summary.p50 << " ms"
+			<< " p95 " << summary.p95 << " ms"
+			<< " p99 " << summary.p99 << " ms"
+			<< " max " << summary.maximum << " ms" << std::endl;
+
+		std::cout << "  submitted " << submittedTotal / std::max(_options.frameCount, 1)
+			<< " triangles per frame" << std::endl;
+
+		Result result;
+		result.renderMode = renderMode;
+		result.summary = summary;
+		result.submittedCount = submittedTotal / std::max(_options.frameCount, 1);
+		result.occludedCount = occludedTotal / std::max(_options.frameCount, 1);
+		_results.push_back(result);
+
+		if (occludedTotal > 0) {
+			std::cout << "  occluded " << occludedTotal / std::max(_options.frameCount, 1)
+				<< " of " << submittedTotal / std::max(_options.frameCount, 1) << " triangles per frame" << std::endl;
+		}
+
+		if (acceptedTotal > 0) {
+			std::cout << "  written without depth tests " << acceptedTotal / std::max(_options.frameCount, 1)
+				<< " of " << submittedTotal / std::max(_options.frameCount, 1) << " triangles per frame" << std::endl;
+		}
+
+		if (clusterTotal.submitted > 0) {
+			const uint32_t frameCount = static_cast<uint32_t>(std::max(_options.frameCount, 1));
+			std::cout << "  clusters culled " << clusterTotal.frustum / frameCount << " frustum, "
+				<< clusterTotal.backFace / frameCount << " back-face, "
+				<< clusterTotal.occluded / frameCount << " occluded of "
+				<< clusterTotal.submitted / frameCount << " per frame" << std::endl;
+		}
+
+		if (octreeTotal.visited > 0) {
+			const uint32_t frameCount = static_cast<uint32_t>(std::max(_options.frameCount, 1));
+			std::cout << "  octree nodes culled " << octreeTotal.frustum / frameCount << " frustum, "
+				<< octreeTotal.occluded / frameCount << " occluded, "
+				<< octreeTotal.inside / frameCount << " inside of the frustum of "
+				<< octreeTotal.visited / frameCount << " visited per frame" << std::endl;
+			if (octreeTotal.potentiallyVisible > 0) {
+				std::cout << "  octree nodes outside of the potentially visible set "
+					<< octreeTotal.potentiallyVisible / frameCount << " per frame" << std::endl;
+			}
+			if (octreeTotal.covered > 0) {
+				std::cout << "  octree subtrees left behind the covered screen "
+					<< octreeTotal.covered << " in " << frameCount << " frames" << std::endl;
+			}
+			if (octreeTotal.splatted > 0) {
+				std::cout << "  octree nodes drawn as splats "
+					<< octreeTotal.splatted / frameCount << " per frame" << std::endl;
+			}
+		}
+
+		if (instanceTotal.submitted > 0) {
+			const uint32_t frameCount = static_cast<uint32_t>(std::max(_options.frameCount, 1));
+			std::cout << "  instances culled " << instanceTotal.frustum / frameCount << " frustum, "
+				<< instanceTotal.occluded / frameCount << " occluded of "
+				<< instanceTotal.submitted / frameCount << " per frame" << std::endl;
+		}
+
+		if (deformTotal > 0.0) {
+			std::cout << "  deformed " << _deformIndices.size() << " triangles per frame, "
+				<< deformTotal / std::max(_options.frameCount, 1) << " ms with the octree refit" << std::endl;
+		}
+
+		if (AllocationCounter::isEnabled()) {
+			std::cout << "  frame arena peak " << _scanlineRenderer->getFrameArena().getPeakBytes() / 1024 << " KiB"
+				<< ", heap allocations in the last frame " << _scanlineRenderer->getFrameAllocationCount() << std::endl;
+		}
+
+		if (_perfStages != nullptr) {
+			if (_perfStages->getCounters().isAvailable()) {
+				_perfStages->print(static_cast<uint64_t>(_options.width) * _options.height);
+			}
+			_perfStages->clear();
+		}
+
+#ifdef ENABLE_OVERDRAW_STATISTICS
+		// totals of all frames of the mode
+		OverdrawCounters::print(overdrawTotal);
+
+		if (!_options.heatmapDirectory.empty()) {
+			const OverdrawCounters& counters = _scanlineRenderer->getOverdrawCounters();
+			const std::string prefix = _options.heatmapDirectory + "/" + ScanlineRenderer::getRenderModeName(renderMode);
+			// a fixed scale keeps the heatmaps of the modes comparable
+			const uint32_t maxCount = 16;
+			if (!counters.writeHeatmap(prefix + "_tests.png", OverdrawCounters::Counter::Test, maxCount) ||
+				!counters.writeHeatmap(prefix + "_writes.png", OverdrawCounters::Counter::Write, maxCount)) {
+				std::cerr << "write heatmap " << prefix << " failure" << std::endl;
+			}
+		}
+#endif
+
+#ifdef ENABLE_PROFILER
+		if (!_options.traceDirectory.empty()) {
+			const std::string filepath =
+				_options.traceDirectory + "/" + ScanlineRenderer::getRenderModeName(renderMode) + ".json";
+			if (!Profiler::get().exportChromeTrace(filepath)) {
+				std::cerr << "write trace " << filepath << " failure" << std::endl;
+			}
+			Profiler::get().printSummary();
+		}
+		Profiler::get().clear();
+#endif
+	}
+
+	if (_frameWriter != nullptr) {
+		_frameWriter->flush();
+	}
+
+	MemoryTracker::get().printSummary();
+
+	if (!_options.statisticsFilepath.empty()) {
+		const std::string& filepath = _options.statisticsFilepath;
+		const bool json = filepath.size() >= 5 && filepath.compare(filepath.size() - 5, 5, ".json") == 0;
+		if (!(json ? _frameStatistics->exportJson(filepath) : _frameStatistics->exportCsv(filepath))) {
+			std::cerr << "write frame statistics " << filepath << " failure" << std::endl;
+		}
+	}
+
+	if (auto sharedFramebuffer = dynamic_cast<SharedFramebuffer*>(_framebuffer)) {
+		const auto& header = sharedFramebuffer->getRing().getHeader();
+		std::cout << "shared memory: "
+			<< header.publishedCount.load() << " published, "
+			<< header.consumedCount.load() << " consumed, "
+			<< header.droppedCount.load() << " dropped, "
+			<< header.stalledCount.load() << " stalled" << std::endl;
+	}
+}
+
+
+/*
+ * @brief get the results of the render modes of the last run
+ */
+const std::vector<Benchmark::Result>& Benchmark::getResults() const {
+	return _results;
+}
+
+
+/*
+ * @brief get the triangles of the scene, of the models without a generated scene
+ */
+uint64_t Benchmark::getSceneTriangleCount() const {
+	return _scene != nullptr ? _scene->getTriangleCount() : _triangles.size();
+}
+
+
+/*
+ * @brief run a benchmark for every value of the swept scene option and
+ *        print a table of all results, exported as csv to statisticsFilepath
+ */
+void Benchmark::sweep(const Options& options) {
+	struct Row {
+		double value;
+		uint64_t triangleCount;
+		Result result;
+	};
+
+	std::vector<Row> rows;
+	for (double value : options.sweepValues) {
+		Options point = options;
+		if (options.sweepParameter == "triangles") {
+			point.scene.triangleCount = static_cast<uint64_t>(value);
+		} else if (options.sweepParameter == "depth") {
+			point.scene.depthComplexity = static_cast<int>(value);
+		} else {
+			point.scene.occlusionRatio = static_cast<float>(value);
+		}
+		// the table of the sweep replaces the statistics of the single runs
+		point.statisticsFilepath.clear();
+
+		std::cout << "sweep " << options.sweepParameter << " " << value << std::endl;
+		Benchmark benchmark(point);
+		benchmark.run();
+		for (const auto& result : benchmark.getResults()) {
+			rows.push_back({ value, benchmark.getSceneTriangleCount(), result });
+		}
+	}
+
+	std::ofstream file;
+	if (!options.statisticsFilepath.empty()) {
+		file.open(options.statisticsFilepath);
+		file << options.sweepParameter << ",scene_triangles,mode,mean_ms,p50_ms,p95_ms,p99_ms,submitted,occluded\n";
+	}
+
+	std::cout << options.sweepParameter << "\tscene triangles\tmode\tmean ms\tp95 ms\tsubmitted\toccluded" << std::endl;
+	for (const auto& row : rows) {
+		const char* name = ScanlineRenderer::getRenderModeName(row.result.renderMode);
+		const FrameStatistics::Summary& summary = row.result.summary;
+		std::cout << row.value << "\t" << row.triangleCount << "\t" << name << "\t"
+			<< summary.mean << "\t" << summary.p95 << "\t"
+			<< row.result.submittedCount << "\t" << row.result.occludedCount << std::endl;
+
+		if (file.is_open()) {
+			file << row.value << "," << row.triangleCount << "," << name << ","
+				<< summary.mean << "," << summary.p50 << "," << summary.p95 << "," << summary.p99 << ","
+				<< row.result.submittedCount << "," << row.result.occludedCount << "\n";
+		}
+	}
+
+	if (file.is_open() && !file) {
+		std::cerr << "write sweep " << options.statisticsFilepath << " failure" << std::endl;
+	}
+}
+
+
+/*
+ * @brief place the camera on the orbit for a frame
+ */
+void Benchmark::_updateCamera(int frame) {
+	const float radius = _options.orbitRadius;
+	const float angle = glm::two_pi<float>() * frame / std::max(_options.frameCount, 1);
+
+	_camera.setLocalPosition(radius * glm::vec3(std::sin(angle), 0.0f, std::cos(angle)));
+	// the view matrix applies the inverse rotation of the camera
+	_camera.setLocalRotation(glm::angleAxis(-angle, glm::vec3(0.0f, 1.0f, 0.0f)));
+}
+
+
+/*
+ * @brief share the geometry of every model between instanceCount instances
+ * @detail the instances of a model are placed on a square grid in the xz plane
+ *         centered at the origin, turned around y so that they differ on screen
+ */
+void Benchmark::_createInstances() {
+	// the instances point into the geometries, which must not move afterwards
+	_geometries.reserve(_models.size());
+	for (const auto& model : _models) {
+		_geometries.emplace_back(model);
+	}
+
+	const int instanceCount = _options.instanceCount;
+	const int columnCount = static_cast<int>(std::ceil(std::sqrt(static_cast<float>(instanceCount))));
+	_instances.reserve(_geometries.size() * instanceCount);
+	for (const auto& geometry : _geometries) {
+		const float spacing = 2.5f * geometry.getRadius();
+		for (int i = 0; i < instanceCount; ++i) {
+			const int row = i / columnCount;
+			const int column = i % columnCount;
+
+			_instances.emplace_back(&geometry);
+			if (instanceCount > 1) {
+				const glm::quat rotation = glm::angleAxis(2.39996f * i, glm::vec3(0.0f, 1.0f, 0.0f));
+				_instances.back().setTransform(spacing * glm::vec3(
+					column - 0.5f * (columnCount - 1), 0.0f, row - 0.5f * (columnCount - 1)) - rotation * geometry.getCenter(),
+					rotation, glm::vec3(1.0f));
+			}
+		}
+	}
+
+	std::cout << "+ instances: " << _instances.size() << " of " << _geometries.size() << " geometries" << std::endl;
+}
+
+
+/*
+ * @brief generate the scene, copy it for the modes without instancing
+ *        and drop the modes which cannot render it
+ */
+void Benchmark::_createScene() {
+	_scene = new SceneGenerator(_options.scene, _models);
+	std::cout << "+ scene:    " << SceneGenerator::getLayoutName(_options.scene.layout) << ", "
+		<< _scene->getInstances().size() << " instances, "
+		<< _scene->getTriangleCount() << " triangles" << std::endl;
+
+	// the models stay for the octree and the clusters of a scene too large to copy
+	const bool flatten = _scene->getTriangleCount() <= _options.flattenLimit;
+	if (flatten) {
+		_triangles.clear();
+		_scene->getTriangles(_triangles);
+	}
+
+	std::vector<ScanlineRenderer::RenderMode> renderModes;
+	for (auto renderMode : _options.renderModes) {
+		const char* name = ScanlineRenderer::getRenderModeName(renderMode);
+		if (renderMode == ScanlineRenderer::RenderMode::Global) {
+			std::cout << "  skip " << name << ", it renders the models only" << std::endl;
+		} else if (renderMode != ScanlineRenderer::RenderMode::Instanced && !flatten) {
+			std::cout << "  skip " << name << ", the scene has more than "
+				<< _options.flattenLimit << " triangles" << std::endl;
+		} else {
+			renderModes.push_back(renderMode);
+		}
+	}
+	_options.renderModes = renderModes;
+}
+
+/*
+ * @brief load the potentially visible set of the octree mode, build it
+ *        around the orbit and write it first if the file is missing
+ * @detail the camera stays at height 0, so the cells form a single layer
+ *         over the square around the orbit
+ */
+void Benchmark::_createVisibleSet() {
+	const std::string& filepath = _options.visibleSetFilepath;
+	if (std::ifstream(filepath).good()) {
+		std::cout << "loading " + filepath + "..." << std::endl;
+		_visibleSet.load(filepath);
+	} else {
+		const int cellCount = _options.visibleSetCellCount;
+		// a little wider than the orbit, whose points on the border would fall outside
+		const float extent = 1.01f * _options.orbitRadius;
+		const float cellSize = 2.0f * extent / cellCount;
+
+		PotentiallyVisibleSet::Options options;
+		options.minPoint = glm::vec3(-extent, -0.5f * cellSize, -extent);
+		options.maxPoint = glm::vec3(extent, 0.5f * cellSize, extent);
+		options.cellCount = glm::ivec3(cellCount, 1, cellCount);
+		options.nearClip = _camera.getNearClip();
+		options.farClip = _camera.getFarClip();
+
+		std::cout << "building potentially visible set of " << cellCount * cellCount << " cells..." << std::endl;
+		auto start = std::chrono::high_resolution_clock::now();
+		_visibleSet.build(options, _triangles);
+		auto stop = std::chrono::high_resolution_clock::now();
+		std::cout << "+ built in " << std::chrono::duration<double>(stop - start).count() << " s" << std::endl;
+
+		_visibleSet.save(filepath);
+	}
+
+	uint64_t visibleCount = 0;
+	for (int i = 0; i < _visibleSet.getCellCount(); ++i) {
+		visibleCount += _visibleSet.getVisibleNodeCount(i);
+	}
+
+	std::cout << "+ visible:  " << visibleCount / _visibleSet.getCellCount() << " of "
+		<< _visibleSet.getNodeCount() << " octree nodes per cell, "
+		<< _visibleSet.getEncodedBytes() / 1024 << " KiB of runs" << std::endl;
+
+	_scanlineRenderer->setPotentiallyVisibleSet(&_visibleSet);
+}
+
+
+/*
+ * @brief move the animated instances for a frame and mark them moved
+ * @detail the instances bob by the radius of their geometry around the
+ *         place they were created at, the scene tree refits their paths only
+ */
+void Benchmark::_animateInstances(int frame) {
+	std::vector<Instance>& instances = _scene != nullptr ? _scene->getInstances() : _instances;
+	if (_animationOrigins.empty()) {
+		for (const auto& instance : instances) {
+			_animationOrigins.push_back(glm::vec3(instance.getModelMatrix()[3]));
+		}
+	}
+
+	const float phase = glm::two_pi<float>() * frame / std::max(_options.frameCount, 1);
+	for (uint32_t i = 0; i < instances.size(); i += 4) {
+		Instance& instance = instances[i];
+		const float height = instance.getGeometry()->getRadius() * std::sin(phase + i);
+		instance.setTransform(_animationOrigins[i] + glm::vec3(0.0f, height, 0.0f),
+			instance.getLocalRotation(), instance.getLocalScale());
+		_scanlineRenderer->getSceneTree()->markMoved(i);
+	}
+}
+
+
+/*
+ * @brief move the deformed triangles for a frame and mark the instances of their geometry moved
+ * @detail every deformed triangle swells and shrinks along its vertex normals
+ *         by about half its edge length, the triangles are spread evenly
+ *         over the geometry. The octree refits the nodes of these triangles
+ *         only and the scene tree the paths of the instances.
+ * @return milliseconds of the deformation and the octree refit
+ */
+double Benchmark::_deformGeometry(int frame) {
+	std::vector<Geometry>& geometries = _scene != nullptr ? _scene->getGeometries() : _geometries;
+	std::vector<Instance>& instances = _scene != nullptr ? _scene->getInstances() : _instances;
+	Geometry& geometry = geometries.front();
+	if (_deformIndices.empty()) {
+		const std::vector<Triangle>& triangles = geometry.getTriangles();
+		const uint32_t stride = static_cast<uint32_t>(std::max(std::round(1.0f / _options.deformShare), 1.0f));
+		for (uint32_t i = 0; i < triangles.size(); i += stride) {
+			_deformIndices.push_back(i);
+			_deformOrigins.push_back(triangles[i]);
+		}
+	}
+
+	const float phase = glm::two_pi<float>() * frame / std::max(_options.frameCount, 1);
+	auto start = std::chrono::high_resolution_clock::now();
+	size_t next = 0;
+	geometry.deform(_deformIndices, [&](Triangle& triangle) {
+		const Triangle& origin = _deformOrigins[next];
+		const float offset = 0.5f * glm::length(origin.v[1].position - origin.v[0].position) *
+			std::sin(phase + _deformIndices[next]);
+		for (int k = 0; k < 3; ++k) {
+			triangle.v[k].position = origin.v[k].position + offset * origin.v[k].normal;
+		}
+		++next;
+	});
+	auto stop = std::chrono::high_resolution_clock::now();
+
+	for (uint32_t i = 0; i < instances.size(); ++i) {
+		if (instances[i].getGeometry() == &geometry) {
+			_scanlineRenderer->getSceneTree()->markMoved(i);
+		}
+	}
+
+	return std::chrono::duration<double, std::milli>(stop - start).count();
+}
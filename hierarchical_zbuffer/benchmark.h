@@ -0,0 +1,234 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <glm/gtc/constants.hpp>
+
+#include "core/memory_tracker.h"
+
+#include "mesh.h"
+#include "model.h"
+#include "fps_camera.h"
+#include "framebuffer.h"
+#include "frame_writer.h"
+#include "frame_statistics.h"
+#include "lod_chain.h"
+#include "potentially_visible_set.h"
+#include "scene_generator.h"
+#include "shared_framebuffer.h"
+#include "scanline_renderer.h"
+
+/*
+ * @brief headless driver of the software renderers
+ * @detail renders the scene on an orbit around the origin with a cpu
+ *         framebuffer, so it runs without a window or an OpenGL context
+ */
+class Benchmark {
+public:
+	struct Options {
+		int width = 1280;
+		int height = 720;
+		/* frames rendered per render mode */
+		int frameCount = 100;
+		std::vector<ScanlineRenderer::RenderMode> renderModes = {
+			ScanlineRenderer::RenderMode::Global,
+			ScanlineRenderer::RenderMode::ZBuffer,
+			ScanlineRenderer::RenderMode::HierarchicalZBuffer,
+			ScanlineRenderer::RenderMode::OctreeHierarchicalZBuffer,
+			ScanlineRenderer::RenderMode::VisibilityBuffer,
+			ScanlineRenderer::RenderMode::Cluster,
+			ScanlineRenderer::RenderMode::Instanced,
+		};
+		std::vector<std::string> modelFilepaths;
+		/* directory the frames are dumped to, no dump if empty */
+		std::string dumpDirectory;
+		enum FrameWriter::Format dumpFormat = FrameWriter::Format::Ppm;
+		/* shared memory frame ring the frames are rendered into, none if empty */
+		std::string sharedMemoryName;
+		int sharedMemorySlotCount = 3;
+		enum SharedFrameRing::Policy sharedMemoryPolicy = SharedFrameRing::Policy::DropOldest;
+		/* directory the overdraw heatmaps of the last frame of each mode are written to */
+		std::string heatmapDirectory;
+		/* directory the chrome traces of each mode are written to */
+		std::string traceDirectory;
+		/* file the frame statistics are exported to, json or csv by extension */
+		std::string statisticsFilepath;
+		/* count hardware events per render stage, linux only, runs the jobs on the calling thread */
+		bool perfCounters = false;
+		/* workers of the job system, negative for one per hardware thread besides the caller */
+		int workerCount = -1;
+		/* bind the workers to hardware threads */
+		bool pinThreads = false;
+		/* submit the triangles front to back in the hzb and visibility modes */
+		bool depthSorting = false;
+		/* largest projected error in pixels of a level of detail, no levels if not positive */
+		float lodPixelError = 0.0f;
+		/* distance of the camera orbit from the origin, automatic if not positive */
+		float orbitRadius = 0.0f;
+		/* instances per model in the instanced mode, on a grid around the origin */
+		int instanceCount = 1;
+		/* move every fourth instance up and down in the instanced mode */
+		bool animate = false;
+		/* share of the triangles of the first geometry moved every frame in the instanced mode, none if not positive */
+		float deformShare = 0.0f;
+		/* screen size in pixels up to which an octree node is drawn as a splat, none if not positive */
+		float splatSize = 0.0f;
+		/* potentially visible set of the octree mode, built and written if missing, none if empty */
+		std::string visibleSetFilepath;
+		/* cells of the potentially visible set along x and z of the orbit */
+		int visibleSetCellCount = 8;
+		/* render a generated scene of instances of the models instead of the models */
+		bool generateScene = false;
+		SceneGenerator::Options scene;
+		/* triangles up to which a generated scene is copied for the modes without instancing */
+		uint64_t flattenLimit = 4000000;
+		/* scene option run through by sweep, triangles, depth or occlusion */
+		std::string sweepParameter;
+		std::vector<double> sweepValues;
+	};
+
+	/* timings and counters of a render mode over all frames */
+	struct Result {
+		enum ScanlineRenderer::RenderMode renderMode;
+		FrameStatistics::Summary summary;
+		/* per frame */
+		uint64_t submittedCount = 0;
+		uint64_t occludedCount = 0;
+	};
+
+	/*
+	 * @brief parse the command line options of the benchmark
+	 * @exception std::invalid_argument for an unknown or incomplete option
+	 */
+	static Options parseOptions(int argc, char* argv[]);
+
+	/*
+	 * @brief print the command line options of the benchmark
+	 */
+	static void printUsage();
+
+	/*
+	 * @brief constructor, load the models and build the renderer
+	 */
+	explicit Benchmark(const Options& options);
+
+	/*
+	 * @brief default destructor
+	 */
+	~Benchmark();
+
+	/*
+	 * @brief render all frames of all render modes and print the timings
+	 */
+	void run();
+
+	/*
+	 * @brief get the results of the render modes of the last run
+	 */
+	const std::vector<Result>& getResults() const;
+
+	/*
+	 * @brief get the triangles of the scene, of the models without a generated scene
+	 */
+	uint64_t getSceneTriangleCount() const;
+
+	/*
+	 * @brief run a benchmark for every value of the swept scene option and
+	 *        print a table of all results, exported as csv to statisticsFilepath
+	 */
+	static void sweep(const Options& options);
+
+private:
+	Options _options;
+
+	/* model */
+	std::vector<Model> _models;
+
+	/* triangle data: local space */
+	std::vector<Triangle> _triangles;
+
+	/* the models and the triangles */
+	MemoryRegistration _meshMemory{ MemoryTag::Meshes };
+
+	/* levels of detail per model, empty if disabled */
+	std::vector<LodChain> _lodChains;
+
+	/* geometry per model shared by its instances, built for the instanced mode only */
+	std::vector<Geometry> _geometries;
+	std::vector<Instance> _instances;
+
+	/* translations of the instances before the animation */
+	std::vector<glm::vec3> _animationOrigins;
+
+	/* deformed triangles of the first geometry and their vertices before the deformation */
+	std::vector<uint32_t> _deformIndices;
+	std::vector<Triangle> _deformOrigins;
+
+	/* generated scene, null if disabled */
+	SceneGenerator* _scene = nullptr;
+
+	/* octree nodes seen from the cells around the orbit, empty if disabled */
+	PotentiallyVisibleSet _visibleSet;
+
+	std::vector<Result> _results;
+
+	/* camera */
+	FpsCamera _camera;
+
+	/* shading, the same as Application */
+	glm::vec4 _clearColor = glm::vec4(1.0f, 1.0f, 1.0f, 1.0f);
+	glm::vec3 _objectColor = glm::vec3(0.9f, 0.9f, 0.9f);
+	glm::vec3 _lightColor = glm::vec3(1.0f, 1.0f, 1.0f);
+	glm::vec3 _lightDirection = -glm::normalize(glm::vec3(0.8f, -3.0f, -1.5f));
+
+	/* cpu render target, a SharedFramebuffer when streaming to shared memory */
+	Framebuffer* _framebuffer = nullptr;
+
+	/* renderer */
+	ScanlineRenderer* _scanlineRenderer = nullptr;
+
+	/* background frame dump, null if disabled */
+	FrameWriter* _frameWriter = nullptr;
+
+	/* frame times, one series per render mode */
+	FrameStatistics* _frameStatistics = nullptr;
+
+	/* hardware counters per render stage, null if disabled */
+	PerfStages* _perfStages = nullptr;
+
+	/*
+	 * @brief place the camera on the orbit for a frame
+	 */
+	void _updateCamera(int frame);
+
+	/*
+	 * @brief share the geometry of every model between instanceCount instances
+	 */
+	void _createInstances();
+
+	/*
+	 * @brief move the animated instances for a frame and mark them moved
+	 */
+	void _animateInstances(int frame);
+
+	/*
+	 * @brief move the deformed triangles for a frame and mark the instances of their geometry moved
+	 * @return milliseconds of the deformation and the octree refit
+	 */
+	double _deformGeometry(int frame);
+
+	/*
+	 * @brief generate the scene, copy it for the modes without instancing
+	 *        and drop the modes which cannot render it
+	 */
+	void _createScene();
+
+	/*
+	 * @brief load the potentially visible set of the octree mode, build it
+	 *        around the orbit and write it first if the file is missing
+	 */
+	void _createVisibleSet();
+};
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+/*
+ * @brief bookkeeping for buffers that are cleared lazily tile by tile
+ * @detail clear() only advances a frame epoch. The first touch of a tile in a
+ *         frame writes the clear value into it, unless the tile still holds the
+ *         clear value from an earlier resolve. resolve() writes the clear value
+ *         into the tiles that were not touched in the frame, so a buffer that
+ *         is presented as a whole is complete. Clear bandwidth is thus paid only
+ *         for tiles that change between covered and uncovered.
+ */
+class ClearTiles {
+public:
+	static constexpr int tileWidth = 32;
+	static constexpr int tileHeight = 8;
+
+	ClearTiles() = default;
+
+	ClearTiles(int width, int height)
+		: _width(width), _height(height),
+		_tileCountX((width + tileWidth - 1) / tileWidth),
+		_tileCountY((height + tileHeight - 1) / tileHeight) {
+		_epochs.resize(static_cast<size_t>(_tileCountX) * _tileCountY, 0);
+		_clean.resize(_epochs.size(), 0);
+	}
+
+	/*
+	 * @brief start a new frame, all tiles are cleared without touching the buffer
+	 */
+	void clear() {
+		if (++_epoch == 0) {
+			std::fill(_epochs.begin(), _epochs.end(), 0);
+			_epoch = 1;
+		}
+	}
+
+	/*
+	 * @brief forget which tiles hold the clear value, e.g. when the clear value
+	 *        changes or the buffer memory is replaced
+	 */
+	void invalidate() {
+		std::fill(_clean.begin(), _clean.end(), 0);
+	}
+
+	/*
+	 * @brief initialize the tiles overlapped by the pixels [xl, xr] of row y
+	 * @param fill callable fill(xl, yl, xr, yr) writing the clear value into
+	 *        the pixel rectangle [xl, xr) x [yl, yr)
+	 */
+	template <typename Fill>
+	void touchSpan(int y, int xl, int xr, Fill&& fill) {
+		const int row = (y / tileHeight) * _tileCountX;
+		for (int tx = xl / tileWidth; tx <= xr / tileWidth; ++tx) {
+			const int tile = row + tx;
+			if (_epochs[tile] != _epoch) {
+				_epochs[tile] = _epoch;
+				if (!_clean[tile]) {
+					_fillTile(tile, fill);
+				}
+				_clean[tile] = 0;
+			}
+		}
+	}
+
+	/*
+	 * @brief write the clear value into the tiles untouched in this frame
+	 * @param fill callable fill(xl, yl, xr, yr) as in touchSpan
+	 */
+	template <typename Fill>
+	void resolve(Fill&& fill) {
+		for (int tile = 0; tile < static_cast<int>(_epochs.size()); ++tile) {
+			if (_epochs[tile] != _epoch && !_clean[tile]) {
+				_fillTile(tile, fill);
+				_clean[tile] = 1;
+			}
+		}
+	}
+
+	/*
+	 * @brief check if a tile has been touched in this frame
+	 */
+	bool isTouched(int tileX, int tileY) const {
+		return _epochs[tileY * _tileCountX + tileX] == _epoch;
+	}
+
+	int getTileCountX() const {
+		return _tileCountX;
+	}
+
+	int getTileCountY() const {
+		return _tileCountY;
+	}
+
+private:
+	int _width = 0, _height = 0;
+
+	int _tileCountX = 0, _tileCountY = 0;
+
+	/* current frame, tiles with a different epoch are cleared */
+	uint32_t _epoch = 1;
+
+	/* frame in which each tile was touched last */
+	std::vector<uint32_t> _epochs;
+
+	/* whether each tile is known to hold the clear value */
+	std::vector<uint8_t> _clean;
+
+	template <typename Fill>
+	void _fillTile(int tile, Fill& fill) {
+		const int xl = (tile % _tileCountX) * tileWidth;
+		const int yl = (tile / _tileCountX) * tileHeight;
+		fill(xl, yl, std::min(xl + tileWidth, _width), std::min(yl + tileHeight, _height));
+	}
+};
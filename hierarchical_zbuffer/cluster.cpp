@@ -0,0 +1,161 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "cluster.h"
+
+
+/*
+ * @brief constructor, build the clusters
+ */
+ClusterSet::ClusterSet(const std::vector<Triangle>& triangles) {
+	const uint32_t count = static_cast<uint32_t>(triangles.size());
+
+	std::vector<glm::vec3> centroids(count);
+	_triangleIndices.resize(count);
+	for (uint32_t i = 0; i < count; ++i) {
+		centroids[i] = (triangles[i].v[0].position + triangles[i].v[1].position + triangles[i].v[2].position) / 3.0f;
+		_triangleIndices[i] = i;
+	}
+
+	_clusters.reserve((count + maxSize - 1) / maxSize * 2);
+	if (count > 0) {
+		_split(triangles, centroids, 0, count);
+	}
+}
+
+
+const std::vector<Cluster, TrackingAllocator<Cluster, MemoryTag::Clusters>>& ClusterSet::getClusters() const {
+	return _clusters;
+}
+
+
+/*
+ * @brief get the triangle indices grouped by cluster
+ */
+const uint32_t* ClusterSet::getTriangleIndices() const {
+	return _triangleIndices.data();
+}
+
+
+/*
+ * @brief check if every triangle of a cluster faces away from a viewer at eye
+ * @detail every normal is within the half angle a of the cone axis. If every
+ *         direction from the eye to the bounding sphere is within 90 - a
+ *         degrees of the axis too, every triangle faces away. The directions
+ *         are bounded by the center with the radius added to both the
+ *         distance and the projection on the axis.
+ */
+bool ClusterSet::isBackFacing(const Cluster& cluster, const glm::vec3& eye) {
+	if (cluster.coneCutoff >= 1.0f) {
+		return false;
+	}
+
+	const glm::vec3 direction = cluster.center - eye;
+	return glm::dot(direction, cluster.coneAxis) - cluster.radius >
+		cluster.coneCutoff * (glm::length(direction) + cluster.radius);
+}
+
+
+/*
+ * @brief check if a cluster is at least partly inside of a view frustum
+ */
+bool ClusterSet::isInFrustum(const Cluster& cluster, const Frustum& frustum) {
+	return frustum.intersectsSphere(cluster.center, cluster.radius);
+}
+
+
+/*
+ * @brief split a range of triangles at the median of the longest axis of its centroids
+ */
+void ClusterSet::_split(
+	const std::vector<Triangle>& triangles,
+	const std::vector<glm::vec3>& centroids,
+	uint32_t first, uint32_t count) {
+	if (count <= maxSize) {
+		_addCluster(triangles, first, count);
+		return;
+	}
+
+	glm::vec3 minPoint(std::numeric_limits<float>::max());
+	glm::vec3 maxPoint(std::numeric_limits<float>::lowest());
+	for (uint32_t i = first; i < first + count; ++i) {
+		minPoint = glm::min(minPoint, centroids[_triangleIndices[i]]);
+		maxPoint = glm::max(maxPoint, centroids[_triangleIndices[i]]);
+	}
+
+	const glm::vec3 extent = maxPoint - minPoint;
+	int axis = 0;
+	if (extent.y > extent[axis]) {
+		axis = 1;
+	}
+	if (extent.z > extent[axis]) {
+		axis = 2;
+	}
+
+	// both halves keep more than maxSize / 2 triangles
+	const uint32_t half = count / 2;
+	auto begin = _triangleIndices.begin() + first;
+	std::nth_element(begin, begin + half, begin + count, [&centroids, axis](uint32_t a, uint32_t b) {
+		return centroids[a][axis] < centroids[b][axis];
+	});
+
+	_split(triangles, centroids, first, half);
+	_split(triangles, centroids, first + half, count - half);
+}
+
+
+/*
+ * @brief compute the bounds and the normal cone of a range of triangles
+ */
+void ClusterSet::_addCluster(const std::vector<Triangle>& triangles, uint32_t first, uint32_t count) {
+	Cluster cluster;
+	cluster.first = first;
+	cluster.count = count;
+	cluster.minPoint = glm::vec3(std::numeric_limits<float>::max());
+	cluster.maxPoint = glm::vec3(std::numeric_limits<float>::lowest());
+
+	// the geometric normals decide the facing, as in the Culler
+	glm::vec3 normalSum(0.0f);
+	for (uint32_t i = first; i < first + count; ++i) {
+		const Triangle& tri = triangles[_triangleIndices[i]];
+		for (int j = 0; j < 3; ++j) {
+			cluster.minPoint = glm::min(cluster.minPoint, tri.v[j].position);
+			cluster.maxPoint = glm::max(cluster.maxPoint, tri.v[j].position);
+		}
+
+		const glm::vec3 normal = glm::cross(
+			tri.v[1].position - tri.v[0].position, tri.v[2].position - tri.v[0].position);
+		const float length = glm::length(normal);
+		if (length > 0.0f) {
+			normalSum += normal / length;
+		}
+	}
+
+	cluster.center = (cluster.minPoint + cluster.maxPoint) * 0.5f;
+	for (uint32_t i = first; i < first + count; ++i) {
+		const Triangle& tri = triangles[_triangleIndices[i]];
+		for (int j = 0; j < 3; ++j) {
+			cluster.radius = std::max(cluster.radius, glm::length(tri.v[j].position - cluster.center));
+		}
+	}
+
+	const float axisLength = glm::length(normalSum);
+	cluster.coneAxis = axisLength > 0.0f ? normalSum / axisLength : glm::vec3(0.0f, 0.0f, 1.0f);
+
+	float minDot = axisLength > 0.0f ? 1.0f : -1.0f;
+	for (uint32_t i = first; i < first + count; ++i) {
+		const Triangle& tri = triangles[_triangleIndices[i]];
+		const glm::vec3 normal = glm::cross(
+			tri.v[1].position - tri.v[0].position, tri.v[2].position - tri.v[0].position);
+		const float length = glm::length(normal);
+		if (length > 0.0f) {
+			minDot = std::min(minDot, glm::dot(normal / length, cluster.coneAxis));
+		}
+	}
+
+	// a cone wider than a half space contains opposite normals, never cull it
+	cluster.coneCutoff = minDot > 0.0f ? std::sqrt(1.0f - minDot * minDot) : 1.0f;
+
+	_clusters.push_back(cluster);
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "core/memory_tracker.h"
+
+#include "frustum.h"
+#include "mesh.h"
+
+/*
+ * @brief a spatially coherent group of triangles culled as a whole
+ */
+struct Cluster {
+	/* bounding sphere */
+	glm::vec3 center;
+	float radius = 0.0f;
+	/* bounding box */
+	glm::vec3 minPoint;
+	glm::vec3 maxPoint;
+	/* normal cone, the sine of its half angle, 1 if it opens to a half space or more */
+	glm::vec3 coneAxis;
+	float coneCutoff = 1.0f;
+	/* triangles [first, first + count) of ClusterSet::getTriangleIndices */
+	uint32_t first = 0;
+	uint32_t count = 0;
+};
+
+
+/*
+ * @brief partition of triangles into clusters of minSize to maxSize triangles
+ * @detail a range of triangles is split at the median of its centroids along
+ *         the longest axis of their bounds until it holds maxSize triangles at
+ *         most, so every cluster but that of a tiny input has minSize or more.
+ *         The clusters are built once, the triangles must not change afterwards.
+ */
+class ClusterSet {
+public:
+	static constexpr uint32_t minSize = 64;
+	static constexpr uint32_t maxSize = 128;
+
+	/* per frame counters of the cluster culling */
+	struct Statistics {
+		/* clusters handed to the culling */
+		uint32_t submitted = 0;
+		/* clusters outside of the view frustum */
+		uint32_t frustum = 0;
+		/* clusters all of whose triangles face away from the camera */
+		uint32_t backFace = 0;
+		/* clusters behind the hierarchical zbuffer */
+		uint32_t occluded = 0;
+	};
+
+	/*
+	 * @brief constructor, build the clusters
+	 */
+	explicit ClusterSet(const std::vector<Triangle>& triangles);
+
+	const std::vector<Cluster, TrackingAllocator<Cluster, MemoryTag::Clusters>>& getClusters() const;
+
+	/*
+	 * @brief get the triangle indices grouped by cluster
+	 */
+	const uint32_t* getTriangleIndices() const;
+
+	/*
+	 * @brief check if every triangle of a cluster faces away from a viewer at eye
+	 */
+	static bool isBackFacing(const Cluster& cluster, const glm::vec3& eye);
+
+	/*
+	 * @brief check if a cluster is at least partly inside of a view frustum
+	 */
+	static bool isInFrustum(const Cluster& cluster, const Frustum& frustum);
+
+private:
+	std::vector<Cluster, TrackingAllocator<Cluster, MemoryTag::Clusters>> _clusters;
+
+	std::vector<uint32_t, TrackingAllocator<uint32_t, MemoryTag::Clusters>> _triangleIndices;
+
+	void _split(const std::vector<Triangle>& triangles,
+		const std::vector<glm::vec3>& centroids, uint32_t first, uint32_t count);
+
+	void _addCluster(const std::vector<Triangle>& triangles, uint32_t first, uint32_t count);
+};
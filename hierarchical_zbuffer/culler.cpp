@@ -0,0 +1,103 @@
+#include "culler.h"
+#include <cmath>
+
+
+/*
+ * @brief cull a triangle before the raster setup
+ * @detail the facing is taken from the determinant of the homogeneous (x, y, w)
+ *         coordinates, which keeps its sign for vertices behind the eye, so no
+ *         division is needed. The zero area and sub pixel tests work on the
+ *         projected positions and only run when all vertices are in front of
+ *         the eye. The rasterizers truncate the positions and emit the rows
+ *         [int(yMin), int(yMax)), so a triangle whose truncated y range is empty
+ *         produces no span at all.
+ * @param clip vertices in homogeneous clip coordinates(mvp * v)
+ * @param screenX x of the vertices in pixels before the rasterizer snaps them
+ * @param screenY y of the vertices in pixels before the rasterizer snaps them
+ * @return the reason why the triangle is culled, or CullResult::Visible
+ */
+Culler::CullResult Culler::cull(const glm::vec4* clip, const float* screenX, const float* screenY) {
+	++_statistics.submitted;
+
+	if (_cullFace != CullFace::None) {
+		const float det =
+			clip[0].x * (clip[1].y * clip[2].w - clip[2].y * clip[1].w) -
+			clip[1].x * (clip[0].y * clip[2].w - clip[2].y * clip[0].w) +
+			clip[2].x * (clip[0].y * clip[1].w - clip[1].y * clip[0].w);
+
+		// counter clockwise triangles are front faces, as in OpenGL
+		if ((_cullFace == CullFace::Back && det < 0.0f) ||
+			(_cullFace == CullFace::Front && det > 0.0f)) {
+			++_statistics.backFace;
+			return CullResult::BackFace;
+		}
+	}
+
+	if (_cullNearPlane &&
+		(clip[0].z < -clip[0].w || clip[1].z < -clip[1].w || clip[2].z < -clip[2].w)) {
+		++_statistics.nearPlane;
+		return CullResult::NearPlane;
+	}
+
+	if (clip[0].w <= 0.0f || clip[1].w <= 0.0f || clip[2].w <= 0.0f) {
+		return CullResult::Visible;
+	}
+
+	if (_cullZeroArea) {
+		const float area2 =
+			(screenX[1] - screenX[0]) * (screenY[2] - screenY[0]) -
+			(screenX[2] - screenX[0]) * (screenY[1] - screenY[0]);
+		if (std::abs(area2) < _zeroAreaEpsilon) {
+			++_statistics.zeroArea;
+			return CullResult::ZeroArea;
+		}
+	}
+
+	if (_cullSubPixel) {
+		const int y0 = static_cast<int>(screenY[0]);
+		if (y0 == static_cast<int>(screenY[1]) && y0 == static_cast<int>(screenY[2])) {
+			++_statistics.subPixel;
+			return CullResult::SubPixel;
+		}
+	}
+
+	return CullResult::Visible;
+}
+
+
+/*
+ * @brief reset the per frame counters
+ */
+void Culler::resetStatistics() {
+	_statistics = Statistics{};
+}
+
+
+const Culler::Statistics& Culler::getStatistics() const {
+	return _statistics;
+}
+
+
+enum Culler::CullFace Culler::getCullFace() const {
+	return _cullFace;
+}
+
+
+void Culler::setCullFace(enum CullFace cullFace) {
+	_cullFace = cullFace;
+}
+
+
+void Culler::setCullZeroArea(bool enable) {
+	_cullZeroArea = enable;
+}
+
+
+void Culler::setCullSubPixel(bool enable) {
+	_cullSubPixel = enable;
+}
+
+
+void Culler::setCullNearPlane(bool enable) {
+	_cullNearPlane = enable;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+#include <glm/vec4.hpp>
+
+class Culler {
+public:
+	enum class CullFace {
+		None, Back, Front
+	};
+
+	enum class CullResult {
+		Visible, BackFace, ZeroArea, SubPixel, NearPlane
+	};
+
+	/* per frame counters of the culling stage */
+	struct Statistics {
+		/* triangles handed to the culling stage */
+		uint32_t submitted = 0;
+		/* triangles facing away from the camera */
+		uint32_t backFace = 0;
+		/* triangles degenerated to a line or a point on screen */
+		uint32_t zeroArea = 0;
+		/* triangles that cover no sample point of a scan line */
+		uint32_t subPixel = 0;
+		/* triangles crossing the near plane, only culled if enabled */
+		uint32_t nearPlane = 0;
+	};
+
+	/*
+	 * @brief cull a triangle before the raster setup
+	 * @param clip vertices in homogeneous clip coordinates(mvp * v)
+	 * @param screenX x of the vertices in pixels before the rasterizer snaps them
+	 * @param screenY y of the vertices in pixels before the rasterizer snaps them
+	 * @return the reason why the triangle is culled, or CullResult::Visible
+	 */
+	CullResult cull(const glm::vec4* clip, const float* screenX, const float* screenY);
+
+	/*
+	 * @brief reset the per frame counters
+	 */
+	void resetStatistics();
+
+	const Statistics& getStatistics() const;
+
+	enum CullFace getCullFace() const;
+
+	void setCullFace(enum CullFace cullFace);
+
+	void setCullZeroArea(bool enable);
+
+	void setCullSubPixel(bool enable);
+
+	/*
+	 * @brief cull the triangles crossing the near plane instead of rasterizing
+	 *        their unclipped projections, which may span far beyond the screen
+	 */
+	void setCullNearPlane(bool enable);
+
+private:
+	/* twice the area in pixels below which a triangle counts as degenerated */
+	static constexpr float _zeroAreaEpsilon = 1.0f / 1024.0f;
+
+	enum CullFace _cullFace = CullFace::Back;
+
+	bool _cullZeroArea = true;
+
+	bool _cullSubPixel = true;
+
+	bool _cullNearPlane = false;
+
+	Statistics _statistics;
+};
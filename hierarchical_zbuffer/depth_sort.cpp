@@ -0,0 +1,123 @@
+#include <algorithm>
+#include <limits>
+
+#include "core/profiler.h"
+#include "depth_sort.h"
+
+
+/*
+ * @brief sort the triangles by their nearest view depth
+ * @param view view matrix, the triangles are in world space
+ * @return triangle indices front to back, valid until the arena is reset.
+ *         Triangles completely behind the camera come last.
+ */
+const uint32_t* DepthSort::sortFrontToBack(
+	const std::vector<Triangle>& triangles,
+	const glm::mat4x4& view,
+	FrameArena& arena,
+	JobSystem& jobSystem) {
+	PROFILE_ZONE("depth sort");
+
+	const int count = static_cast<int>(triangles.size());
+	const int blockCount = std::clamp(
+		(count + _minBlockSize - 1) / _minBlockSize, 1, jobSystem.getWorkerCount() + 1);
+	const int blockSize = (count + blockCount - 1) / blockCount;
+
+	// nearest depth per triangle, negative if the triangle is behind the camera
+	float* depths = arena.allocateArray<float>(count);
+	float* blockNearest = arena.allocateArray<float>(blockCount);
+	float* blockFarthest = arena.allocateArray<float>(blockCount);
+	uint16_t* keys[2] = { arena.allocateArray<uint16_t>(count), arena.allocateArray<uint16_t>(count) };
+	uint32_t* indices[2] = { arena.allocateArray<uint32_t>(count), arena.allocateArray<uint32_t>(count) };
+	uint32_t* histograms = arena.allocateArray<uint32_t>(static_cast<size_t>(blockCount) * _radixSize);
+
+	// view space z of a world space position, the camera looks along -z
+	const glm::vec4 depthRow = -glm::vec4(view[0][2], view[1][2], view[2][2], view[3][2]);
+
+	jobSystem.parallelFor(0, blockCount, 1, [&](int block) {
+		float nearest = std::numeric_limits<float>::max();
+		float farthest = 0.0f;
+		const int last = std::min(count, (block + 1) * blockSize);
+		for (int i = block * blockSize; i < last; ++i) {
+			float minDepth = std::numeric_limits<float>::max();
+			float maxDepth = std::numeric_limits<float>::lowest();
+			for (int j = 0; j < 3; ++j) {
+				const float depth = glm::dot(depthRow, glm::vec4(triangles[i].v[j].position, 1.0f));
+				minDepth = std::min(minDepth, depth);
+				maxDepth = std::max(maxDepth, depth);
+			}
+
+			if (maxDepth < 0.0f) {
+				depths[i] = -1.0f;
+				continue;
+			}
+
+			depths[i] = std::max(minDepth, 0.0f);
+			nearest = std::min(nearest, depths[i]);
+			farthest = std::max(farthest, depths[i]);
+		}
+
+		blockNearest[block] = nearest;
+		blockFarthest[block] = farthest;
+	});
+
+	float nearest = std::numeric_limits<float>::max();
+	float farthest = 0.0f;
+	for (int block = 0; block < blockCount; ++block) {
+		nearest = std::min(nearest, blockNearest[block]);
+		farthest = std::max(farthest, blockFarthest[block]);
+	}
+
+	const float maxKey = std::numeric_limits<uint16_t>::max();
+	const float scale = farthest > nearest ? maxKey / (farthest - nearest) : 0.0f;
+	jobSystem.parallelFor(0, blockCount, 1, [&](int block) {
+		const int last = std::min(count, (block + 1) * blockSize);
+		for (int i = block * blockSize; i < last; ++i) {
+			const float key = depths[i] < 0.0f ? maxKey : std::min((depths[i] - nearest) * scale, maxKey);
+			keys[0][i] = static_cast<uint16_t>(key);
+			indices[0][i] = static_cast<uint32_t>(i);
+		}
+	});
+
+	for (int pass = 0; pass < 2; ++pass) {
+		const int shift = pass * _radixBits;
+		const uint16_t* srcKeys = keys[pass];
+		const uint32_t* srcIndices = indices[pass];
+		uint16_t* dstKeys = keys[pass ^ 1];
+		uint32_t* dstIndices = indices[pass ^ 1];
+
+		jobSystem.parallelFor(0, blockCount, 1, [&](int block) {
+			uint32_t* histogram = histograms + static_cast<size_t>(block) * _radixSize;
+			std::fill(histogram, histogram + _radixSize, 0u);
+			const int last = std::min(count, (block + 1) * blockSize);
+			for (int i = block * blockSize; i < last; ++i) {
+				++histogram[(srcKeys[i] >> shift) & (_radixSize - 1)];
+			}
+		});
+
+		// the histograms become the first destination of each digit per block,
+		// lower blocks first to keep the sort stable
+		uint32_t offset = 0;
+		for (int digit = 0; digit < _radixSize; ++digit) {
+			for (int block = 0; block < blockCount; ++block) {
+				uint32_t& slot = histograms[static_cast<size_t>(block) * _radixSize + digit];
+				const uint32_t digitCount = slot;
+				slot = offset;
+				offset += digitCount;
+			}
+		}
+
+		jobSystem.parallelFor(0, blockCount, 1, [&](int block) {
+			uint32_t* offsets = histograms + static_cast<size_t>(block) * _radixSize;
+			const int last = std::min(count, (block + 1) * blockSize);
+			for (int i = block * blockSize; i < last; ++i) {
+				const uint32_t destination = offsets[(srcKeys[i] >> shift) & (_radixSize - 1)]++;
+				dstKeys[destination] = srcKeys[i];
+				dstIndices[destination] = srcIndices[i];
+			}
+		});
+	}
+
+	// an even number of passes ends in the first buffer
+	return indices[0];
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <glm/mat4x4.hpp>
+
+#include "core/frame_arena.h"
+#include "core/job_system.h"
+
+#include "mesh.h"
+
+/*
+ * @brief coarse front to back order of triangles without a spatial structure
+ * @detail the key of a triangle is its nearest view depth quantized to 16
+ *         bits over the depth range of the frame. The keys are sorted by a
+ *         stable two pass lsd radix sort, every pass counts and scatters
+ *         blocks of triangles as jobs. All buffers come from the frame arena.
+ */
+class DepthSort {
+public:
+	/*
+	 * @brief sort the triangles by their nearest view depth
+	 * @param view view matrix, the triangles are in world space
+	 * @return triangle indices front to back, valid until the arena is reset.
+	 *         Triangles completely behind the camera come last.
+	 */
+	static const uint32_t* sortFrontToBack(
+		const std::vector<Triangle>& triangles,
+		const glm::mat4x4& view,
+		FrameArena& arena,
+		JobSystem& jobSystem = JobSystem::get());
+
+private:
+	/* triangles per block below which more blocks do not pay off */
+	static constexpr int _minBlockSize = 4096;
+
+	static constexpr int _radixBits = 8;
+	static constexpr int _radixSize = 1 << _radixBits;
+};
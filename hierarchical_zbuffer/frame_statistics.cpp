@@ -0,0 +1,182 @@
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+#include "frame_statistics.h"
+
+
+/*
+ * @brief constructor
+ * @param seriesNames name of each series, used by the exports
+ * @param windowSize number of latest frames the statistics are computed over
+ */
+FrameStatistics::FrameStatistics(const std::vector<std::string>& seriesNames, int windowSize)
+	: _windowSize(std::max(windowSize, 1)) {
+	_series.resize(seriesNames.size());
+	for (size_t i = 0; i < seriesNames.size(); ++i) {
+		_series[i].name = seriesNames[i];
+		_series[i].frames.resize(_windowSize);
+	}
+
+	_sorted.resize(_windowSize);
+}
+
+
+/*
+ * @brief record the time of a frame
+ */
+void FrameStatistics::record(int series, double milliseconds) {
+	Series& s = _series[series];
+	s.frames[s.head] = milliseconds;
+	s.head = (s.head + 1) % _windowSize;
+	s.count = std::min(s.count + 1, _windowSize);
+	++s.totalCount;
+}
+
+
+/*
+ * @brief get the statistics of the frames in the window of a series
+ */
+FrameStatistics::Summary FrameStatistics::getSummary(int series) const {
+	const Series& s = _series[series];
+
+	Summary summary;
+	summary.count = s.count;
+	summary.totalCount = s.totalCount;
+	if (s.count == 0) {
+		return summary;
+	}
+
+	// the order within the window does not matter here
+	std::copy(s.frames.begin(), s.frames.begin() + s.count, _sorted.begin());
+	std::sort(_sorted.begin(), _sorted.begin() + s.count);
+
+	double total = 0.0;
+	for (int i = 0; i < s.count; ++i) {
+		total += _sorted[i];
+	}
+
+	summary.minimum = _sorted[0];
+	summary.mean = total / s.count;
+	summary.p50 = _getPercentile(_sorted.data(), s.count, 50.0);
+	summary.p95 = _getPercentile(_sorted.data(), s.count, 95.0);
+	summary.p99 = _getPercentile(_sorted.data(), s.count, 99.0);
+	summary.maximum = _sorted[s.count - 1];
+
+	return summary;
+}
+
+
+/*
+ * @brief forget all frames
+ */
+void FrameStatistics::clear() {
+	for (auto& series : _series) {
+		series.head = 0;
+		series.count = 0;
+		series.totalCount = 0;
+	}
+}
+
+
+int FrameStatistics::getSeriesCount() const {
+	return static_cast<int>(_series.size());
+}
+
+
+const std::string& FrameStatistics::getSeriesName(int series) const {
+	return _series[series].name;
+}
+
+
+/*
+ * @brief write the summary of every recorded series as csv
+ * @return true on success
+ */
+bool FrameStatistics::exportCsv(const std::string& filepath) const {
+	std::ofstream file(filepath);
+	file << "series,count,total_count,min_ms,mean_ms,p50_ms,p95_ms,p99_ms,max_ms\n";
+	for (int i = 0; i < getSeriesCount(); ++i) {
+		const Summary summary = getSummary(i);
+		if (summary.count == 0) {
+			continue;
+		}
+
+		file << _series[i].name << ","
+			<< summary.count << ","
+			<< summary.totalCount << ","
+			<< summary.minimum << ","
+			<< summary.mean << ","
+			<< summary.p50 << ","
+			<< summary.p95 << ","
+			<< summary.p99 << ","
+			<< summary.maximum << "\n";
+	}
+
+	return static_cast<bool>(file);
+}
+
+
+/*
+ * @brief write the summary and the frame times of every recorded series as json
+ * @return true on success
+ */
+bool FrameStatistics::exportJson(const std::string& filepath) const {
+	std::ofstream file(filepath);
+	file << "{\n  \"windowSize\": " << _windowSize << ",\n  \"series\": [";
+
+	bool first = true;
+	for (int i = 0; i < getSeriesCount(); ++i) {
+		const Summary summary = getSummary(i);
+		if (summary.count == 0) {
+			continue;
+		}
+
+		file << (first ? "\n" : ",\n")
+			<< "    {\"name\": \"" << _series[i].name << "\""
+			<< ", \"count\": " << summary.count
+			<< ", \"totalCount\": " << summary.totalCount
+			<< ", \"min\": " << summary.minimum
+			<< ", \"mean\": " << summary.mean
+			<< ", \"p50\": " << summary.p50
+			<< ", \"p95\": " << summary.p95
+			<< ", \"p99\": " << summary.p99
+			<< ", \"max\": " << summary.maximum
+			<< ", \"frames\": [";
+		first = false;
+
+		bool firstFrame = true;
+		_forEachFrame(_series[i], [&file, &firstFrame](double milliseconds) {
+			file << (firstFrame ? "" : ", ") << milliseconds;
+			firstFrame = false;
+		});
+
+		file << "]}";
+	}
+
+	file << "\n  ]\n}\n";
+
+	return static_cast<bool>(file);
+}
+
+
+/*
+ * @brief get a percentile of sorted frame times, nearest rank
+ */
+double FrameStatistics::_getPercentile(const double* sorted, int count, double percentile) {
+	const int rank = static_cast<int>(std::ceil(percentile / 100.0 * count));
+	return sorted[std::clamp(rank - 1, 0, count - 1)];
+}
+
+
+/*
+ * @brief call back the frame times of a series from the oldest to the latest
+ */
+template <typename Callback>
+void FrameStatistics::_forEachFrame(const Series& series, Callback&& callback) {
+	const int windowSize = static_cast<int>(series.frames.size());
+	const int first = series.count < windowSize ? 0 : series.head;
+	for (int i = 0; i < series.count; ++i) {
+		callback(series.frames[(first + i) % windowSize]);
+	}
+}
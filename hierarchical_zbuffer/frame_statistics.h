@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+ * @brief rolling frame times of several series, e.g. one per render mode
+ * @detail every series keeps the latest windowSize frame times in a ring.
+ *         All memory is allocated in the constructor, record and getSummary
+ *         do not allocate.
+ */
+class FrameStatistics {
+public:
+	struct Summary {
+		/* frames in the window */
+		int count = 0;
+		/* frames recorded since the construction */
+		uint64_t totalCount = 0;
+		/* milliseconds */
+		double minimum = 0.0;
+		double mean = 0.0;
+		double p50 = 0.0;
+		double p95 = 0.0;
+		double p99 = 0.0;
+		double maximum = 0.0;
+	};
+
+	/*
+	 * @brief constructor
+	 * @param seriesNames name of each series, used by the exports
+	 * @param windowSize number of latest frames the statistics are computed over
+	 */
+	FrameStatistics(const std::vector<std::string>& seriesNames, int windowSize = 600);
+
+	/*
+	 * @brief record the time of a frame
+	 */
+	void record(int series, double milliseconds);
+
+	/*
+	 * @brief get the statistics of the frames in the window of a series
+	 */
+	Summary getSummary(int series) const;
+
+	/*
+	 * @brief forget all frames
+	 */
+	void clear();
+
+	int getSeriesCount() const;
+
+	const std::string& getSeriesName(int series) const;
+
+	/*
+	 * @brief write the summary of every recorded series as csv
+	 * @return true on success
+	 */
+	bool exportCsv(const std::string& filepath) const;
+
+	/*
+	 * @brief write the summary and the frame times of every recorded series as json
+	 * @return true on success
+	 */
+	bool exportJson(const std::string& filepath) const;
+
+private:
+	struct Series {
+		std::string name;
+		/* ring of frame times, [0, count) valid, next write at head */
+		std::vector<double> frames;
+		int head = 0;
+		int count = 0;
+		uint64_t totalCount = 0;
+	};
+
+	int _windowSize = 0;
+
+	std::vector<Series> _series;
+
+	/* sorted copy of a window for the percentiles */
+	mutable std::vector<double> _sorted;
+
+	/*
+	 * @brief get a percentile of sorted frame times, nearest rank
+	 */
+	static double _getPercentile(const double* sorted, int count, double percentile);
+
+	/*
+	 * @brief call back the frame times of a series from the oldest to the latest
+	 */
+	template <typename Callback>
+	static void _forEachFrame(const Series& series, Callback&& callback);
+};
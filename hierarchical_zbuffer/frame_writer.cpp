@@ -0,0 +1,182 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <stb_image_write.h>
+
+#include "frame_writer.h"
+
+
+/*
+ * @brief constructor, start the writer thread
+ * @param directory existing directory the frames are written to
+ * @param format image format of the frames
+ * @param slotCount number of frames that can be pending at the same time
+ */
+FrameWriter::FrameWriter(const std::string& directory, enum Format format,
+	int width, int height, int slotCount)
+	: _directory(directory), _format(format), _width(width), _height(height) {
+	_slots.resize(std::max(slotCount, 1));
+	for (auto& slot : _slots) {
+		slot.pixels.resize(static_cast<size_t>(width) * height);
+	}
+
+	if (_format != Format::Raw) {
+		_rgb.resize(static_cast<size_t>(width) * height * 3);
+	}
+
+	_thread = std::thread(&FrameWriter::_run, this);
+}
+
+
+/*
+ * @brief destructor, write the pending frames and stop the writer thread
+ */
+FrameWriter::~FrameWriter() {
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_stop = true;
+	}
+
+	_frameSubmitted.notify_one();
+	_thread.join();
+}
+
+
+/*
+ * @brief queue a resolved frame for writing
+ * @param framebuffer frame of the same size as the writer
+ * @param frameIndex index used in the file name
+ */
+void FrameWriter::submit(const Framebuffer& framebuffer, uint64_t frameIndex) {
+	std::unique_lock<std::mutex> lock(_mutex);
+	_frameWritten.wait(lock, [this]() {
+		return _pendingCount + (_writing ? 1 : 0) < _slots.size();
+	});
+
+	// the slot after the pending ones is free, the one being written is before _tail,
+	// so the copy can be done outside the lock
+	Slot& slot = _slots[(_tail + _pendingCount) % _slots.size()];
+	lock.unlock();
+
+	std::memcpy(slot.pixels.data(), framebuffer.getPixels(), slot.pixels.size() * sizeof(uint32_t));
+	slot.frameIndex = frameIndex;
+
+	lock.lock();
+	++_pendingCount;
+	lock.unlock();
+
+	_frameSubmitted.notify_one();
+}
+
+
+/*
+ * @brief wait until all submitted frames are written
+ */
+void FrameWriter::flush() {
+	std::unique_lock<std::mutex> lock(_mutex);
+	_frameWritten.wait(lock, [this]() {
+		return _pendingCount == 0 && !_writing;
+	});
+}
+
+
+/*
+ * @brief get the format from its name, ppm, png or raw
+ * @exception std::invalid_argument for an unknown name
+ */
+enum FrameWriter::Format FrameWriter::parseFormat(const std::string& name) {
+	if (name == "ppm") {
+		return Format::Ppm;
+	} else if (name == "png") {
+		return Format::Png;
+	} else if (name == "raw") {
+		return Format::Raw;
+	}
+
+	throw std::invalid_argument("unknown frame format " + name);
+}
+
+
+/*
+ * @brief main loop of the writer thread
+ */
+void FrameWriter::_run() {
+	while (true) {
+		std::unique_lock<std::mutex> lock(_mutex);
+		_frameSubmitted.wait(lock, [this]() {
+			return _pendingCount > 0 || _stop;
+		});
+
+		if (_pendingCount == 0) {
+			return;
+		}
+
+		const Slot& slot = _slots[_tail];
+		_tail = (_tail + 1) % _slots.size();
+		--_pendingCount;
+		_writing = true;
+		lock.unlock();
+
+		_write(slot);
+
+		lock.lock();
+		_writing = false;
+		lock.unlock();
+
+		_frameWritten.notify_all();
+	}
+}
+
+
+/*
+ * @brief encode a frame and write it to disk
+ * @detail framebuffer rows are bottom up, ppm and png rows are top down,
+ *         raw frames are the framebuffer memory as is
+ */
+void FrameWriter::_write(const Slot& slot) {
+	static const char* extensions[] = { "ppm", "png", "rgba" };
+
+	char filename[32];
+	std::snprintf(filename, sizeof(filename), "frame_%06llu.%s",
+		static_cast<unsigned long long>(slot.frameIndex), extensions[static_cast<int>(_format)]);
+	const std::string filepath = _directory + "/" + filename;
+
+	if (_format == Format::Raw) {
+		std::ofstream file(filepath, std::ios::binary);
+		file.write(reinterpret_cast<const char*>(slot.pixels.data()),
+			slot.pixels.size() * sizeof(uint32_t));
+		if (!file) {
+			std::cerr << "write frame " << filepath << " failure" << std::endl;
+		}
+		return;
+	}
+
+	for (int y = 0; y < _height; ++y) {
+		const uint32_t* src = slot.pixels.data() + static_cast<size_t>(_height - 1 - y) * _width;
+		uint8_t* dst = _rgb.data() + static_cast<size_t>(y) * _width * 3;
+		for (int x = 0; x < _width; ++x) {
+			dst[3 * x] = src[x] & 0xff;
+			dst[3 * x + 1] = (src[x] >> 8) & 0xff;
+			dst[3 * x + 2] = (src[x] >> 16) & 0xff;
+		}
+	}
+
+	bool success = false;
+	if (_format == Format::Ppm) {
+		std::ofstream file(filepath, std::ios::binary);
+		file << "P6\n" << _width << " " << _height << "\n255\n";
+		file.write(reinterpret_cast<const char*>(_rgb.data()), _rgb.size());
+		success = static_cast<bool>(file);
+	} else {
+		success = stbi_write_png(filepath.c_str(), _width, _height, 3, _rgb.data(), _width * 3) != 0;
+	}
+
+	if (!success) {
+		std::cerr << "write frame " << filepath << " failure" << std::endl;
+	}
+}
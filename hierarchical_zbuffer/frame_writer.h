@@ -0,0 +1,95 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "framebuffer.h"
+
+/*
+ * @brief write finished frames to disk on a background thread
+ * @detail submit copies the pixels into one of a few preallocated slots and
+ *         returns, the writer thread encodes the slot while the next frame is
+ *         rasterized. submit only blocks when all slots are still pending.
+ */
+class FrameWriter {
+public:
+	enum class Format {
+		Ppm, Png, Raw
+	};
+
+	/*
+	 * @brief constructor, start the writer thread
+	 * @param directory existing directory the frames are written to
+	 * @param format image format of the frames
+	 * @param slotCount number of frames that can be pending at the same time
+	 */
+	FrameWriter(const std::string& directory, enum Format format,
+		int width, int height, int slotCount = 2);
+
+	/*
+	 * @brief destructor, write the pending frames and stop the writer thread
+	 */
+	~FrameWriter();
+
+	FrameWriter(const FrameWriter&) = delete;
+
+	FrameWriter& operator=(const FrameWriter&) = delete;
+
+	/*
+	 * @brief queue a resolved frame for writing, called from a single thread
+	 * @param framebuffer frame of the same size as the writer
+	 * @param frameIndex index used in the file name
+	 */
+	void submit(const Framebuffer& framebuffer, uint64_t frameIndex);
+
+	/*
+	 * @brief wait until all submitted frames are written
+	 */
+	void flush();
+
+	/*
+	 * @brief get the format from its name, ppm, png or raw
+	 * @exception std::invalid_argument for an unknown name
+	 */
+	static enum Format parseFormat(const std::string& name);
+
+private:
+	struct Slot {
+		std::vector<uint32_t> pixels;
+		uint64_t frameIndex = 0;
+	};
+
+	std::string _directory;
+	enum Format _format;
+	int _width = 0, _height = 0;
+
+	/* ring of frames, [_tail, _tail + _pendingCount) are waiting for the writer */
+	std::vector<Slot> _slots;
+	size_t _tail = 0;
+	size_t _pendingCount = 0;
+	bool _writing = false;
+	bool _stop = false;
+
+	std::mutex _mutex;
+	std::condition_variable _frameSubmitted;
+	std::condition_variable _frameWritten;
+
+	/* top down RGB rows for the image encoders, only used by the writer thread */
+	std::vector<uint8_t> _rgb;
+
+	std::thread _thread;
+
+	/*
+	 * @brief main loop of the writer thread
+	 */
+	void _run();
+
+	/*
+	 * @brief encode a frame and write it to disk
+	 */
+	void _write(const Slot& slot);
+};
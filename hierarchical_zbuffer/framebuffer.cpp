@@ -1,169 +1,115 @@
 #include "framebuffer.h"
 #include <algorithm>
+#include <cstring>
+#include <new>
 
 
 Framebuffer::Framebuffer(int width, int height) :
-	_width(width), _height(height) {
-	_initQuad();
-	_initShader();
-	_initTexture();
+	_width(width), _height(height), _tiles(width, height) {
+	// allocate memory for pixels, aligned for wide stores
+	_pixels = static_cast<uint32_t*>(::operator new[](
+		static_cast<size_t>(_width) * _height * sizeof(uint32_t), std::align_val_t(_alignment)));
+	_memory.resize(static_cast<size_t>(_width) * _height * sizeof(uint32_t));
 }
 
 
-Framebuffer::Framebuffer(Framebuffer&& framebuffer) noexcept {
-	_texture = framebuffer._texture;
-	framebuffer._texture = 0;
+Framebuffer::Framebuffer(int width, int height, uint32_t* pixels) :
+	_pixels(pixels), _ownsPixels(false), _width(width), _height(height), _tiles(width, height) { }
+
 
+Framebuffer::Framebuffer(Framebuffer&& framebuffer) noexcept {
 	_pixels = framebuffer._pixels;
 	framebuffer._pixels = nullptr;
+	_ownsPixels = framebuffer._ownsPixels;
 
 	_width = framebuffer._width;
 	_height = framebuffer._height;
 
-	_vao = framebuffer._vao;
-	framebuffer._vao = 0;
-
-	_vbo = framebuffer._vbo;
-	framebuffer._vbo = 0;
-
-	_ebo = framebuffer._ebo;
-	framebuffer._ebo = 0;
-
-	for (int i = 0; i < 16; ++i) {
-		_quadVertices[i] = framebuffer._quadVertices[i];
-	}
-
-	for (int i = 0; i < 6; ++i) {
-		_quadIndices[i] = framebuffer._quadIndices[i];
-	}
+	_tiles = std::move(framebuffer._tiles);
+	_clearColor = framebuffer._clearColor;
+	_memory = std::move(framebuffer._memory);
 }
 
 
 Framebuffer::~Framebuffer() {
-	if (_pixels) {
-		delete _pixels;
+	if (_pixels && _ownsPixels) {
+		::operator delete[](_pixels, std::align_val_t(_alignment));
 		_pixels = nullptr;
 	}
+}
 
-	if (_texture) {
-		glDeleteTextures(1, &_texture);
-		_texture = 0;
-	}
-
-	if (_shader) {
-		delete _shader;
-		_shader = nullptr;
-	}
 
-	if (_vao) {
-		glDeleteVertexArrays(1, &_vao);
-		_vao = 0;
-	}
+uint32_t Framebuffer::packColor(const glm::vec3& color) {
+	const uint32_t r = static_cast<uint32_t>(255 * std::clamp(color.r, 0.0f, 1.0f));
+	const uint32_t g = static_cast<uint32_t>(255 * std::clamp(color.g, 0.0f, 1.0f));
+	const uint32_t b = static_cast<uint32_t>(255 * std::clamp(color.b, 0.0f, 1.0f));
+	return r | (g << 8) | (b << 16) | 0xff000000u;
+}
 
-	if (_vbo) {
-		glDeleteBuffers(1, &_vbo);
-		_vbo = 0;
-	}
 
-	if (_ebo) {
-		glDeleteBuffers(1, &_ebo);
-		_ebo = 0;
-	}
+void Framebuffer::setPixel(int x, int y, const glm::vec3& color) {
+	setPixel(x, y, packColor(color));
 }
 
 
-void Framebuffer::setPixel(int x, int y, const glm::vec3& color) {
-	const int offset = 3 * (y * _width + x);
-	_pixels[offset] = static_cast<uint8_t>(255 * std::clamp(color.r, 0.0f, 1.0f));
-	_pixels[offset + 1] = static_cast<uint8_t>(255 * std::clamp(color.g, 0.0f, 1.0f));
-	_pixels[offset + 2] = static_cast<uint8_t>(255 * std::clamp(color.b, 0.0f, 1.0f));
+void Framebuffer::setSpan(int y, int xl, int xr, uint32_t color) {
+	touchSpan(y, xl, xr);
+	std::fill(_pixels + y * _width + xl, _pixels + y * _width + xr + 1, color);
 }
 
 
 void Framebuffer::clear(const glm::vec3& color) {
-	const int size = _width * _height * 3;
-	for (int i = 0; i < size; i += 3) {
-		_pixels[i] = static_cast<uint8_t>(255 * color.r);
-		_pixels[i + 1] = static_cast<uint8_t>(255 * color.g);
-		_pixels[i + 2] = static_cast<uint8_t>(255 * color.b);
-	}
+	clear(packColor(color));
 }
 
 
-void Framebuffer::render() const {
-	_shader->use();
-	
-	glBindTexture(GL_TEXTURE_2D, _texture);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, _width, _height, 0, GL_RGB, GL_UNSIGNED_BYTE, _pixels);
-	
-	glBindVertexArray(_vao);
-	glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-	glBindVertexArray(0);
-	
-	glBindTexture(GL_TEXTURE_2D, 0);
+void Framebuffer::clear(uint32_t color) {
+	if (color != _clearColor) {
+		_tiles.invalidate();
+		_clearColor = color;
+	}
+
+	_tiles.clear();
 }
 
 
-void Framebuffer::_initQuad() {
-	// generate geometry data for a quad representing the image to screen
-	glGenVertexArrays(1, &_vao);
-	glBindVertexArray(_vao);
+void Framebuffer::resolve() {
+	_tiles.resolve([this](int xl, int yl, int xr, int yr) {
+		_fill(xl, yl, xr, yr, _clearColor);
+	});
+}
 
-	glGenBuffers(1, &_vbo);
-	glBindBuffer(GL_ARRAY_BUFFER, _vbo);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(_quadVertices), _quadVertices, GL_STATIC_DRAW);
 
-	glGenBuffers(1, &_ebo);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _ebo);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(_quadIndices), _quadIndices, GL_STATIC_DRAW);
+void Framebuffer::render() {
+	resolve();
+}
 
-	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat), (GLvoid*)0);
-	glEnableVertexAttribArray(0);
-	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat), (GLvoid*)(2 * sizeof(GLfloat)));
-	glEnableVertexAttribArray(1);
 
-	glBindVertexArray(0);
+int Framebuffer::getWidth() const {
+	return _width;
 }
 
 
-void Framebuffer::_initShader() {
-	// generate the shader to the quad
-	const char* vsCode =
-		"#version 330 core\n"
-		"layout (location = 0) in vec2 position;\n"
-		"layout (location = 1) in vec2 texCoord;\n"
-		"out vec2 TexCoord;\n"
-		"void main() {\n"
-		"gl_Position = vec4(position, 0.0f, 1.0f);\n"
-		"TexCoord = texCoord;\n"
-		"}\n";
-
-	const char* fsCode =
-		"#version 330 core\n"
-		"in vec2 TexCoord;\n"
-		"out vec4 color;\n"
-		"uniform sampler2D ourTexture;\n"
-		"void main() {\n"
-		"color = texture(ourTexture, TexCoord);\n"
-		"}\n";
-
-	_shader = new Shader(vsCode, fsCode);
+int Framebuffer::getHeight() const {
+	return _height;
 }
 
 
-void Framebuffer::_initTexture() {
-	// allocate memory for pixels
-	_pixels = new uint8_t[static_cast<size_t>(_width) * _height * 3];
-
-	// generate texture data for a quad representing the image to screen
-	glGenTextures(1, &_texture);
+const uint32_t* Framebuffer::getPixels() const {
+	return _pixels;
+}
 
-	glBindTexture(GL_TEXTURE_2D, _texture);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, _width, _height, 0, GL_RGB, GL_UNSIGNED_BYTE, nullptr);
 
-	glBindTexture(GL_TEXTURE_2D, 0);
+void Framebuffer::_fill(int xl, int yl, int xr, int yr, uint32_t color) {
+	const uint8_t byte = color & 0xff;
+	const bool uniformBytes = color == byte * 0x01010101u;
+	for (int y = yl; y < yr; ++y) {
+		uint32_t* row = _pixels + static_cast<size_t>(y) * _width;
+		if (uniformBytes) {
+			// e.g. white or black, all bytes of the pixel are the same
+			std::memset(row + xl, byte, (xr - xl) * sizeof(uint32_t));
+		} else {
+			std::fill(row + xl, row + xr, color);
+		}
+	}
 }
\ No newline at end of file
@@ -1,49 +1,103 @@
 #pragma once
 
-#include <glad/glad.h>
+#include <cstdint>
 
-#include "shader.h"
+#include <glm/vec3.hpp>
 
+#include "core/memory_tracker.h"
+
+#include "clear_tiles.h"
+
+/*
+ * @brief cpu render target of the software renderers
+ * @detail rows are stored bottom up as in OpenGL, see GlFramebuffer for
+ *         presenting the pixels in a window
+ */
 class Framebuffer {
 public:
 	Framebuffer(int width, int height);
 
 	Framebuffer(Framebuffer&& framebuffer) noexcept;
 
-	~Framebuffer();
+	virtual ~Framebuffer();
+
+	/*
+	 * @brief pack a color into a RGBA8 pixel, red in the lowest byte
+	 */
+	static uint32_t packColor(const glm::vec3& color);
 
+	/*
+	 * @brief clear the framebuffer lazily, see ClearTiles
+	 */
 	void clear(const glm::vec3& color);
 
+	void clear(uint32_t color);
+
+	/*
+	 * @brief make the pixels [xl, xr] of the row y writable in this frame
+	 * @note setPixel relies on the pixel being touched since the last clear
+	 */
+	void touchSpan(int y, int xl, int xr) {
+		_tiles.touchSpan(y, xl, xr, [this](int xl, int yl, int xr, int yr) {
+			_fill(xl, yl, xr, yr, _clearColor);
+		});
+	}
+
 	void setPixel(int x, int y, const glm::vec3& color);
 
-	void display() const;
+	void setPixel(int x, int y, uint32_t color) {
+		_pixels[y * _width + x] = color;
+	}
 
-private:
-	unsigned char* _pixels = nullptr;
-	int _width = 0, _height = 0;
+	/*
+	 * @brief fill the pixels [xl, xr] of the row y with a packed color
+	 */
+	void setSpan(int y, int xl, int xr, uint32_t color);
 
-	GLuint _texture = 0;
+	/*
+	 * @brief write the clear color into the tiles untouched since the last clear
+	 */
+	void resolve();
 
-	GLuint _vao = 0, _vbo = 0, _ebo = 0;
+	/*
+	 * @brief present the finished frame, the cpu framebuffer only resolves it
+	 */
+	virtual void render();
 
-	GLfloat _quadVertices[16] = {
-	//   ----xy----   ----uv----
-		 1.0f,  1.0f, 1.0f, 1.0f,
-	 	 1.0f, -1.0f, 1.0f, 0.0f,
-		-1.0f, -1.0f, 0.0f, 0.0f,
-		-1.0f,  1.0f, 0.0f, 1.0f
-	};
+	int getWidth() const;
+
+	int getHeight() const;
+
+	/*
+	 * @brief get the pixels of the frame, complete after resolve
+	 */
+	const uint32_t* getPixels() const;
+
+protected:
+	/* alignment of the pixel storage in bytes, one cache line */
+	static constexpr size_t _alignment = 64;
+
+	uint32_t* _pixels = nullptr;
+	/* false if the pixel storage is provided by a derived class */
+	bool _ownsPixels = true;
+	int _width = 0, _height = 0;
 
-	GLuint _quadIndices[6] = {
-		0, 1, 3,
-		1, 2, 3
-	};
+	/* lazily cleared tiles of the pixels */
+	ClearTiles _tiles;
 
-	Shader* _shader = nullptr;
+	/* packed clear color of the current frame */
+	uint32_t _clearColor = 0;
 
-	void initQuad();
+	/* pixel storage, also registered by derived classes owning it */
+	MemoryRegistration _memory{ MemoryTag::Framebuffer };
 
-	void initShader();
+	/*
+	 * @brief constructor for storage owned by a derived class
+	 */
+	Framebuffer(int width, int height, uint32_t* pixels);
 
-	void initTexture();
-};
\ No newline at end of file
+	/*
+	 * @brief fill the pixel rectangle [xl, xr) x [yl, yr) with a packed color
+	 */
+	void _fill(int xl, int yl, int xr, int yr, uint32_t color);
+};
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstdint>
+
+#include <glm/glm.hpp>
+
+/*
+ * @brief the 6 planes of a view frustum in world space
+ * @detail the planes are extracted from the rows of the view projection
+ *         matrix (Gribb and Hartmann) for the OpenGL clip volume -w <= z <= w.
+ *         Their normals point into the frustum and are normalized, so a plane
+ *         gives the signed distance of a point.
+ */
+struct Frustum {
+	enum Plane {
+		Left, Right, Bottom, Top, Near, Far, PlaneCount
+	};
+
+	/* plane mask of a box not known to be inside of any plane */
+	static constexpr uint8_t allPlanes = (1 << PlaneCount) - 1;
+
+	/* (normal, distance) per plane */
+	glm::vec4 planes[PlaneCount];
+
+	Frustum() = default;
+
+	explicit Frustum(const glm::mat4x4& viewProjection) {
+		const glm::mat4x4 m = glm::transpose(viewProjection);
+		planes[Left] = m[3] + m[0];
+		planes[Right] = m[3] - m[0];
+		planes[Bottom] = m[3] + m[1];
+		planes[Top] = m[3] - m[1];
+		planes[Near] = m[3] + m[2];
+		planes[Far] = m[3] - m[2];
+
+		for (auto& plane : planes) {
+			plane /= glm::length(glm::vec3(plane));
+		}
+	}
+
+	/*
+	 * @brief get the signed distance of a point to a plane, positive inside
+	 */
+	float getDistance(int plane, const glm::vec3& point) const {
+		return glm::dot(glm::vec3(planes[plane]), point) + planes[plane].w;
+	}
+
+	/*
+	 * @brief check if a sphere is at least partly inside, conservative near the corners
+	 */
+	bool intersectsSphere(const glm::vec3& center, float radius) const {
+		for (int i = 0; i < PlaneCount; ++i) {
+			if (getDistance(i, center) < -radius) {
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	/*
+	 * @brief check if a box is at least partly inside, conservative near the corners
+	 * @param mask bit i set if plane i is to be tested, the bits of the planes
+	 *        the box is completely inside of are cleared. A box inside of
+	 *        a parent box inherits the mask of the parent, a mask of 0 skips
+	 *        all tests.
+	 */
+	bool intersectsBox(const glm::vec3& center, const glm::vec3& extent, uint8_t& mask) const {
+		for (int i = 0; i < PlaneCount; ++i) {
+			if (!(mask & (1 << i))) {
+				continue;
+			}
+
+			// the projection of the half extent onto the normal
+			const float radius = glm::dot(extent, glm::abs(glm::vec3(planes[i])));
+			const float distance = getDistance(i, center);
+			if (distance < -radius) {
+				return false;
+			}
+
+			if (distance >= radius) {
+				mask &= ~(1 << i);
+			}
+		}
+
+		return true;
+	}
+};
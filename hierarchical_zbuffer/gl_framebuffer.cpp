@@ -0,0 +1,141 @@
+#include "gl_framebuffer.h"
+
+
+GlFramebuffer::GlFramebuffer(int width, int height) : Framebuffer(width, height) {
+	_initQuad();
+	_initShader();
+	_initTexture();
+}
+
+
+GlFramebuffer::GlFramebuffer(GlFramebuffer&& framebuffer) noexcept
+	: Framebuffer(std::move(framebuffer)) {
+	_texture = framebuffer._texture;
+	framebuffer._texture = 0;
+
+	_vao = framebuffer._vao;
+	framebuffer._vao = 0;
+
+	_vbo = framebuffer._vbo;
+	framebuffer._vbo = 0;
+
+	_ebo = framebuffer._ebo;
+	framebuffer._ebo = 0;
+
+	_shader = framebuffer._shader;
+	framebuffer._shader = nullptr;
+
+	for (int i = 0; i < 16; ++i) {
+		_quadVertices[i] = framebuffer._quadVertices[i];
+	}
+
+	for (int i = 0; i < 6; ++i) {
+		_quadIndices[i] = framebuffer._quadIndices[i];
+	}
+}
+
+
+GlFramebuffer::~GlFramebuffer() {
+	if (_texture) {
+		glDeleteTextures(1, &_texture);
+		_texture = 0;
+	}
+
+	if (_shader) {
+		delete _shader;
+		_shader = nullptr;
+	}
+
+	if (_vao) {
+		glDeleteVertexArrays(1, &_vao);
+		_vao = 0;
+	}
+
+	if (_vbo) {
+		glDeleteBuffers(1, &_vbo);
+		_vbo = 0;
+	}
+
+	if (_ebo) {
+		glDeleteBuffers(1, &_ebo);
+		_ebo = 0;
+	}
+}
+
+
+void GlFramebuffer::render() {
+	Framebuffer::render();
+
+	_shader->use();
+	
+	glBindTexture(GL_TEXTURE_2D, _texture);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, _width, _height, 0, GL_RGBA, GL_UNSIGNED_INT_8_8_8_8_REV, _pixels);
+	
+	glBindVertexArray(_vao);
+	glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+	glBindVertexArray(0);
+	
+	glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+
+void GlFramebuffer::_initQuad() {
+	// generate geometry data for a quad representing the image to screen
+	glGenVertexArrays(1, &_vao);
+	glBindVertexArray(_vao);
+
+	glGenBuffers(1, &_vbo);
+	glBindBuffer(GL_ARRAY_BUFFER, _vbo);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(_quadVertices), _quadVertices, GL_STATIC_DRAW);
+
+	glGenBuffers(1, &_ebo);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _ebo);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(_quadIndices), _quadIndices, GL_STATIC_DRAW);
+
+	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat), (GLvoid*)0);
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat), (GLvoid*)(2 * sizeof(GLfloat)));
+	glEnableVertexAttribArray(1);
+
+	glBindVertexArray(0);
+}
+
+
+void GlFramebuffer::_initShader() {
+	// generate the shader to the quad
+	const char* vsCode =
+		"#version 330 core\n"
+		"layout (location = 0) in vec2 position;\n"
+		"layout (location = 1) in vec2 texCoord;\n"
+		"out vec2 TexCoord;\n"
+		"void main() {\n"
+		"gl_Position = vec4(position, 0.0f, 1.0f);\n"
+		"TexCoord = texCoord;\n"
+		"}\n";
+
+	const char* fsCode =
+		"#version 330 core\n"
+		"in vec2 TexCoord;\n"
+		"out vec4 color;\n"
+		"uniform sampler2D ourTexture;\n"
+		"void main() {\n"
+		"color = texture(ourTexture, TexCoord);\n"
+		"}\n";
+
+	_shader = new Shader(vsCode, fsCode);
+}
+
+
+void GlFramebuffer::_initTexture() {
+	// generate texture data for a quad representing the image to screen
+	glGenTextures(1, &_texture);
+
+	glBindTexture(GL_TEXTURE_2D, _texture);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, _width, _height, 0, GL_RGBA, GL_UNSIGNED_INT_8_8_8_8_REV, nullptr);
+
+	glBindTexture(GL_TEXTURE_2D, 0);
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include "shader.h"
+#include "framebuffer.h"
+
+/*
+ * @brief framebuffer presented to the current OpenGL context as a textured quad
+ */
+class GlFramebuffer : public Framebuffer {
+public:
+	GlFramebuffer(int width, int height);
+
+	GlFramebuffer(GlFramebuffer&& framebuffer) noexcept;
+
+	~GlFramebuffer();
+
+	/*
+	 * @brief resolve the frame and draw it to the current OpenGL context
+	 */
+	void render() override;
+
+private:
+	GLuint _texture = 0;
+
+	GLuint _vao = 0, _vbo = 0, _ebo = 0;
+
+	GLfloat _quadVertices[16] = {
+	//   ----xy----   ----uv----
+		 1.0f,  1.0f, 1.0f, 1.0f,
+	 	 1.0f, -1.0f, 1.0f, 0.0f,
+		-1.0f, -1.0f, 0.0f, 0.0f,
+		-1.0f,  1.0f, 0.0f, 1.0f
+	};
+
+	GLuint _quadIndices[6] = {
+		0, 1, 3,
+		1, 2, 3
+	};
+
+	Shader* _shader = nullptr;
+
+	void _initQuad();
+
+	void _initShader();
+
+	void _initTexture();
+};
@@ -0,0 +1,175 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "instance.h"
+
+
+/*
+ * @brief constructor, copy the faces of all meshes of a model once
+ */
+Geometry::Geometry(const Model& model) {
+	std::vector<Vertex> vertices;
+	std::vector<uint32_t> indices;
+	model.getFaces(vertices, indices);
+
+	_triangles.reserve(indices.size() / 3);
+	for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+		_triangles.push_back({ vertices[indices[i]], vertices[indices[i + 1]], vertices[indices[i + 2]] });
+	}
+
+	_computeBounds();
+	_octree = new Octree(&_triangles, _octreeThreshold);
+}
+
+
+Geometry::Geometry(std::vector<Triangle> triangles) : _triangles(std::move(triangles)) {
+	_computeBounds();
+	_octree = new Octree(&_triangles, _octreeThreshold);
+}
+
+
+/*
+ * @brief move constructor, the octree keeps pointing into the moved triangles
+ */
+Geometry::Geometry(Geometry&& other) noexcept
+	: _triangles(std::move(other._triangles)),
+	_minPoint(other._minPoint), _maxPoint(other._maxPoint),
+	_center(other._center), _radius(other._radius),
+	_memory(std::move(other._memory)),
+	_octree(other._octree) {
+	other._octree = nullptr;
+}
+
+
+Geometry::~Geometry() {
+	if (_octree != nullptr) {
+		delete _octree;
+		_octree = nullptr;
+	}
+}
+
+
+const std::vector<Triangle>& Geometry::getTriangles() const {
+	return _triangles;
+}
+
+
+const Octree* Geometry::getOctree() const {
+	return _octree;
+}
+
+
+const glm::vec3& Geometry::getMinPoint() const {
+	return _minPoint;
+}
+
+
+const glm::vec3& Geometry::getMaxPoint() const {
+	return _maxPoint;
+}
+
+
+const glm::vec3& Geometry::getCenter() const {
+	return _center;
+}
+
+
+float Geometry::getRadius() const {
+	return _radius;
+}
+
+
+void Geometry::_computeBounds() {
+	if (_triangles.empty()) {
+		return;
+	}
+
+	_minPoint = glm::vec3(std::numeric_limits<float>::max());
+	_maxPoint = glm::vec3(std::numeric_limits<float>::lowest());
+	for (const auto& triangle : _triangles) {
+		for (const auto& vertex : triangle.v) {
+			_minPoint = glm::min(_minPoint, vertex.position);
+			_maxPoint = glm::max(_maxPoint, vertex.position);
+		}
+	}
+
+	_center = 0.5f * (_minPoint + _maxPoint);
+	for (const auto& triangle : _triangles) {
+		for (const auto& vertex : triangle.v) {
+			_radius = std::max(_radius, glm::length(vertex.position - _center));
+		}
+	}
+
+	_memory.resize(_triangles.capacity() * sizeof(Triangle));
+}
+
+
+/*
+ * @brief take the bounds from the root of the refit octree, the sphere
+ *        encloses the box
+ */
+void Geometry::_refitBounds() {
+	if (_triangles.empty()) {
+		return;
+	}
+
+	_minPoint = _octree->getRoot()->minPoint;
+	_maxPoint = _octree->getRoot()->maxPoint;
+	_center = 0.5f * (_minPoint + _maxPoint);
+	_radius = 0.5f * glm::length(_maxPoint - _minPoint);
+}
+
+
+Instance::Instance(const Geometry* geometry) : _geometry(geometry) { }
+
+
+const Geometry* Instance::getGeometry() const {
+	return _geometry;
+}
+
+
+/*
+ * @brief scale, rotate and then translate the geometry by position
+ * @detail Object3D::getModelMatrix translates by the local position before
+ *         it rotates and scales, the local position is chosen to match
+ */
+void Instance::setTransform(const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale) {
+	setLocalRotation(rotation);
+	setLocalScale(scale);
+	setLocalPosition((glm::inverse(rotation) * position) / scale);
+}
+
+
+/*
+ * @brief get the bounding sphere in world space
+ * @detail the radius grows with the largest scale of the axes
+ */
+void Instance::getWorldSphere(const glm::mat4x4& modelMatrix, glm::vec3& center, float& radius) const {
+	center = glm::vec3(modelMatrix * glm::vec4(_geometry->getCenter(), 1.0f));
+	const float scale = std::max({
+		glm::length(glm::vec3(modelMatrix[0])),
+		glm::length(glm::vec3(modelMatrix[1])),
+		glm::length(glm::vec3(modelMatrix[2])) });
+	radius = _geometry->getRadius() * scale;
+}
+
+
+/*
+ * @brief get the box in world space bounding the transformed model space box
+ * @detail the half extent of the box is taken through the absolute values of
+ *         the linear part of the matrix (Arvo), no corner is transformed
+ */
+void Instance::getWorldBox(const glm::mat4x4& modelMatrix, glm::vec3& minPoint, glm::vec3& maxPoint) const {
+	const glm::vec3 center = glm::vec3(modelMatrix * glm::vec4(0.5f * (_geometry->getMinPoint() + _geometry->getMaxPoint()), 1.0f));
+	const glm::vec3 extent = 0.5f * (_geometry->getMaxPoint() - _geometry->getMinPoint());
+
+	const glm::mat3x3 absolute(
+		glm::abs(glm::vec3(modelMatrix[0])),
+		glm::abs(glm::vec3(modelMatrix[1])),
+		glm::abs(glm::vec3(modelMatrix[2])));
+	const glm::vec3 worldExtent = absolute * extent;
+
+	minPoint = center - worldExtent;
+	maxPoint = center + worldExtent;
+}
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "core/memory_tracker.h"
+
+#include "mesh.h"
+#include "model.h"
+#include "object3d.h"
+#include "octree.h"
+
+/*
+ * @brief triangles in model space shared by any number of instances
+ * @detail the triangles are sorted into a local octree, which the instances
+ *         traverse through their model matrices
+ */
+class Geometry {
+public:
+	/*
+	 * @brief constructor, copy the faces of all meshes of a model once
+	 */
+	explicit Geometry(const Model& model);
+
+	explicit Geometry(std::vector<Triangle> triangles);
+
+	/* the octree keeps pointing into the moved triangles */
+	Geometry(Geometry&& other) noexcept;
+
+	Geometry(const Geometry&) = delete;
+
+	Geometry& operator=(const Geometry&) = delete;
+
+	~Geometry();
+
+	const std::vector<Triangle>& getTriangles() const;
+
+	const Octree* getOctree() const;
+
+	/*
+	 * @brief move vertices of a deforming geometry and refit the bounds
+	 * @detail the octree refits only the nodes of the moved triangles, the
+	 *         instances of the geometry must be marked moved in their scene tree
+	 * @param triangleIndices triangles whose vertices changed
+	 * @param update callback changing a triangle, called once per index
+	 */
+	template <typename Update>
+	void deform(const std::vector<uint32_t>& triangleIndices, Update&& update) {
+		for (uint32_t index : triangleIndices) {
+			update(_triangles[index]);
+		}
+
+		_octree->refit(triangleIndices);
+		_refitBounds();
+	}
+
+	/* bounds in model space */
+	const glm::vec3& getMinPoint() const;
+
+	const glm::vec3& getMaxPoint() const;
+
+	const glm::vec3& getCenter() const;
+
+	float getRadius() const;
+
+private:
+	std::vector<Triangle> _triangles;
+
+	glm::vec3 _minPoint = glm::vec3(0.0f);
+	glm::vec3 _maxPoint = glm::vec3(0.0f);
+
+	/* bounding sphere */
+	glm::vec3 _center = glm::vec3(0.0f);
+	float _radius = 0.0f;
+
+	MemoryRegistration _memory{ MemoryTag::Meshes };
+
+	/* triangles below which a node of the octree is not split */
+	static constexpr size_t _octreeThreshold = 20;
+
+	Octree* _octree = nullptr;
+
+	void _computeBounds();
+
+	/*
+	 * @brief take the bounds from the root of the refit octree, the sphere
+	 *        encloses the box
+	 */
+	void _refitBounds();
+};
+
+
+/*
+ * @brief a transform of a shared geometry, the geometry must outlive it
+ */
+class Instance : public Object3D {
+public:
+	/* per frame counters of the instance culling */
+	struct Statistics {
+		/* instances handed to the culling */
+		uint32_t submitted = 0;
+		/* instances outside of the view frustum */
+		uint32_t frustum = 0;
+		/* instances behind the hierarchical zbuffer */
+		uint32_t occluded = 0;
+	};
+
+	explicit Instance(const Geometry* geometry);
+
+	const Geometry* getGeometry() const;
+
+	/*
+	 * @brief scale, rotate and then translate the geometry by position
+	 * @detail Object3D::getModelMatrix translates by the local position before
+	 *         it rotates and scales, the local position is chosen to match
+	 */
+	void setTransform(const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale);
+
+	/*
+	 * @brief get the bounding sphere in world space
+	 * @param modelMatrix the model matrix of the instance, computed once by the caller
+	 */
+	void getWorldSphere(const glm::mat4x4& modelMatrix, glm::vec3& center, float& radius) const;
+
+	/*
+	 * @brief get the box in world space bounding the transformed model space box
+	 * @param modelMatrix the model matrix of the instance, computed once by the caller
+	 */
+	void getWorldBox(const glm::mat4x4& modelMatrix, glm::vec3& minPoint, glm::vec3& maxPoint) const;
+
+private:
+	const Geometry* _geometry = nullptr;
+};
@@ -0,0 +1,101 @@
+#include <algorithm>
+#include <limits>
+
+#include "lod_chain.h"
+#include "mesh_simplifier.h"
+
+
+/*
+ * @brief constructor, simplify the meshes of the model
+ * @param maxLevelCount levels including the full mesh
+ * @param minTriangleCount triangles below which no further level is built
+ */
+LodChain::LodChain(const Model& model, int maxLevelCount, uint32_t minTriangleCount) {
+	std::vector<Vertex> vertices;
+	std::vector<uint32_t> indices;
+	model.getFaces(vertices, indices);
+
+	Level full;
+	full.triangles.reserve(indices.size() / 3);
+	for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+		full.triangles.push_back({ vertices[indices[i]], vertices[indices[i + 1]], vertices[indices[i + 2]] });
+	}
+
+	glm::vec3 minPoint(std::numeric_limits<float>::max());
+	glm::vec3 maxPoint(std::numeric_limits<float>::lowest());
+	for (const auto& vertex : vertices) {
+		minPoint = glm::min(minPoint, vertex.position);
+		maxPoint = glm::max(maxPoint, vertex.position);
+	}
+
+	if (!vertices.empty()) {
+		_center = 0.5f * (minPoint + maxPoint);
+		for (const auto& vertex : vertices) {
+			_radius = std::max(_radius, glm::length(vertex.position - _center));
+		}
+	}
+
+	uint32_t triangleCount = static_cast<uint32_t>(full.triangles.size());
+	_levels.push_back(std::move(full));
+
+	MeshSimplifier simplifier(vertices, indices);
+	while (static_cast<int>(_levels.size()) < maxLevelCount && triangleCount / 2 >= minTriangleCount) {
+		if (!simplifier.simplify(triangleCount / 2)) {
+			break;
+		}
+
+		Level level;
+		simplifier.getTriangles(level.triangles);
+		level.error = simplifier.getError();
+		triangleCount = static_cast<uint32_t>(level.triangles.size());
+		_levels.push_back(std::move(level));
+	}
+
+	size_t bytes = 0;
+	for (const auto& level : _levels) {
+		bytes += level.triangles.capacity() * sizeof(Triangle);
+	}
+	_memory.resize(bytes);
+}
+
+
+int LodChain::getLevelCount() const {
+	return static_cast<int>(_levels.size());
+}
+
+
+const LodChain::Level& LodChain::getLevel(int level) const {
+	return _levels[level];
+}
+
+
+/*
+ * @brief get the coarsest level whose projected error is at most maxPixelError
+ * @param eye camera position in model space
+ * @param pixelsPerUnit pixels covered by one unit at distance 1, e.g.
+ *        projection[1][1] * height / 2 for a perspective projection
+ */
+int LodChain::selectLevel(const glm::vec3& eye, float pixelsPerUnit, float maxPixelError) const {
+	for (int level = getLevelCount() - 1; level > 0; --level) {
+		if (getPixelError(level, eye, pixelsPerUnit) <= maxPixelError) {
+			return level;
+		}
+	}
+
+	return 0;
+}
+
+
+/*
+ * @brief get the error of a level in pixels seen from eye
+ * @detail the error is projected at the nearest point of the bounding sphere,
+ *         an eye inside of the sphere sees every error as infinitely large
+ */
+float LodChain::getPixelError(int level, const glm::vec3& eye, float pixelsPerUnit) const {
+	const float distance = glm::length(eye - _center) - _radius;
+	if (distance <= 0.0f) {
+		return _levels[level].error > 0.0f ? std::numeric_limits<float>::max() : 0.0f;
+	}
+
+	return _levels[level].error * pixelsPerUnit / distance;
+}
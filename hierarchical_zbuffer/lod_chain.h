@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "core/memory_tracker.h"
+
+#include "mesh.h"
+#include "model.h"
+
+/*
+ * @brief levels of detail of a model, from the full mesh to the coarsest
+ * @detail every level halves the triangles of the previous one with
+ *         MeshSimplifier in a single run, so the geometric error of a level
+ *         bounds the deviation from the full mesh, not only from the level
+ *         before. A level is picked by its error projected to pixels at the
+ *         distance of the bounding sphere of the model.
+ */
+class LodChain {
+public:
+	struct Level {
+		std::vector<Triangle> triangles;
+		/* largest distance from the full mesh in model units, 0 for the full mesh */
+		float error = 0.0f;
+	};
+
+	/*
+	 * @brief constructor, simplify the meshes of the model
+	 * @param maxLevelCount levels including the full mesh
+	 * @param minTriangleCount triangles below which no further level is built
+	 */
+	explicit LodChain(const Model& model, int maxLevelCount = 8, uint32_t minTriangleCount = 256);
+
+	int getLevelCount() const;
+
+	const Level& getLevel(int level) const;
+
+	/*
+	 * @brief get the coarsest level whose projected error is at most maxPixelError
+	 * @param eye camera position in model space
+	 * @param pixelsPerUnit pixels covered by one unit at distance 1, e.g.
+	 *        projection[1][1] * height / 2 for a perspective projection
+	 */
+	int selectLevel(const glm::vec3& eye, float pixelsPerUnit, float maxPixelError) const;
+
+	/*
+	 * @brief get the error of a level in pixels seen from eye
+	 */
+	float getPixelError(int level, const glm::vec3& eye, float pixelsPerUnit) const;
+
+private:
+	std::vector<Level> _levels;
+
+	/* bounding sphere of the full mesh */
+	glm::vec3 _center = glm::vec3(0.0f);
+	float _radius = 0.0f;
+
+	/* the triangles of all levels */
+	MemoryRegistration _memory{ MemoryTag::Meshes };
+};
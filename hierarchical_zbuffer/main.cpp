@@ -1,16 +1,32 @@
 #include <iostream>
 #include <stdexcept>
+#include <string>
 
 #include "application.h"
+#include "benchmark.h"
 
 /* program entry point */
-int main() {
+int main(int argc, char* argv[]) {
 	try {
-		Application app;
-		app.run();
+		if (argc > 1 && std::string(argv[1]) == "--benchmark") {
+			// headless: no window, no OpenGL context
+			const Benchmark::Options options = Benchmark::parseOptions(argc - 2, argv + 2);
+			if (options.sweepValues.empty()) {
+				Benchmark benchmark(options);
+				benchmark.run();
+			} else {
+				Benchmark::sweep(options);
+			}
+		} else {
+			Application app;
+			app.run();
+		}
+	} catch (const std::invalid_argument& e) {
+		std::cerr << e.what() << std::endl;
+		Benchmark::printUsage();
 	} catch (const std::exception& e) {
 		std::cerr << e.what() << std::endl;
 	}
 
 	return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,404 @@
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+#include "mesh_simplifier.h"
+
+
+MeshSimplifier::Quadric::Quadric(const glm::dvec4& plane, double weight) {
+	const double a = plane.x, b = plane.y, c = plane.z, d = plane.w;
+	m[0] = weight * a * a; m[1] = weight * a * b; m[2] = weight * a * c; m[3] = weight * a * d;
+	m[4] = weight * b * b; m[5] = weight * b * c; m[6] = weight * b * d;
+	m[7] = weight * c * c; m[8] = weight * c * d;
+	m[9] = weight * d * d;
+}
+
+
+MeshSimplifier::Quadric& MeshSimplifier::Quadric::operator+=(const Quadric& other) {
+	for (int i = 0; i < 10; ++i) {
+		m[i] += other.m[i];
+	}
+
+	return *this;
+}
+
+
+double MeshSimplifier::Quadric::evaluate(const glm::dvec3& p) const {
+	return p.x * (m[0] * p.x + 2.0 * (m[1] * p.y + m[2] * p.z + m[3])) +
+		p.y * (m[4] * p.y + 2.0 * (m[5] * p.z + m[6])) +
+		p.z * (m[7] * p.z + 2.0 * m[8]) +
+		m[9];
+}
+
+
+/*
+ * @brief get the position of the least error
+ * @return false if the quadric is singular
+ */
+bool MeshSimplifier::Quadric::getOptimum(glm::dvec3& p) const {
+	const glm::dmat3 a(
+		m[0], m[1], m[2],
+		m[1], m[4], m[5],
+		m[2], m[5], m[7]);
+	const double det = glm::determinant(a);
+	// relative to the scale of the matrix, flat and straight neighborhoods are singular
+	const double scale = m[0] + m[4] + m[7];
+	if (std::abs(det) <= 1e-9 * scale * scale * scale) {
+		return false;
+	}
+
+	p = glm::inverse(a) * -glm::dvec3(m[3], m[6], m[8]);
+	return true;
+}
+
+
+/*
+ * @brief constructor
+ * @param vertices vertices of the mesh, only the positions are used
+ * @param indices 3 vertex indices per triangle
+ */
+MeshSimplifier::MeshSimplifier(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices) {
+	// weld the vertices with the same position, sorted so that equal positions are adjacent
+	std::vector<uint32_t> order(vertices.size());
+	std::iota(order.begin(), order.end(), 0);
+	auto less = [&vertices](uint32_t a, uint32_t b) {
+		const glm::vec3& p = vertices[a].position;
+		const glm::vec3& q = vertices[b].position;
+		return p.x != q.x ? p.x < q.x : (p.y != q.y ? p.y < q.y : p.z < q.z);
+	};
+	std::sort(order.begin(), order.end(), less);
+
+	std::vector<uint32_t> remap(vertices.size());
+	for (size_t i = 0; i < order.size(); ++i) {
+		if (i == 0 || less(order[i - 1], order[i])) {
+			_positions.push_back(vertices[order[i]].position);
+		}
+		remap[order[i]] = static_cast<uint32_t>(_positions.size() - 1);
+	}
+
+	for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+		const uint32_t a = remap[indices[i]], b = remap[indices[i + 1]], c = remap[indices[i + 2]];
+		if (a != b && b != c && c != a) {
+			_indices.insert(_indices.end(), { a, b, c });
+		}
+	}
+
+	const size_t vertexCount = _positions.size();
+	_triangleCount = static_cast<uint32_t>(_indices.size() / 3);
+	_quadrics.resize(vertexCount);
+	_versions.resize(vertexCount, 0);
+	_removedVertices.resize(vertexCount, false);
+	_removedTriangles.resize(_triangleCount, false);
+	_vertexTriangles.resize(vertexCount);
+
+	// (smaller vertex, larger vertex, triangle) of every edge, a border edge occurs once
+	struct HalfEdge {
+		uint32_t a, b, triangle;
+	};
+	std::vector<HalfEdge> edges;
+	edges.reserve(_indices.size());
+
+	std::vector<glm::dvec4> planes(_triangleCount);
+	for (uint32_t t = 0; t < _triangleCount; ++t) {
+		const uint32_t* v = &_indices[3 * t];
+		const glm::dvec3 p0 = _positions[v[0]], p1 = _positions[v[1]], p2 = _positions[v[2]];
+		glm::dvec3 normal = glm::cross(p1 - p0, p2 - p0);
+		const double length = glm::length(normal);
+		normal = length > 0.0 ? normal / length : glm::dvec3(0.0);
+		planes[t] = glm::dvec4(normal, -glm::dot(normal, p0));
+
+		const Quadric quadric(planes[t], 1.0);
+		for (int j = 0; j < 3; ++j) {
+			_quadrics[v[j]] += quadric;
+			_vertexTriangles[v[j]].push_back(t);
+			edges.push_back(HalfEdge{ std::min(v[j], v[(j + 1) % 3]), std::max(v[j], v[(j + 1) % 3]), t });
+		}
+	}
+
+	std::sort(edges.begin(), edges.end(), [](const HalfEdge& x, const HalfEdge& y) {
+		return x.a != y.a ? x.a < y.a : x.b < y.b;
+	});
+
+	for (size_t i = 0; i < edges.size(); ++i) {
+		const bool shared =
+			(i > 0 && edges[i - 1].a == edges[i].a && edges[i - 1].b == edges[i].b) ||
+			(i + 1 < edges.size() && edges[i + 1].a == edges[i].a && edges[i + 1].b == edges[i].b);
+		if (!shared) {
+			const glm::dvec3 p0 = _positions[edges[i].a], p1 = _positions[edges[i].b];
+			glm::dvec3 normal = glm::cross(p1 - p0, glm::dvec3(planes[edges[i].triangle]));
+			const double length = glm::length(normal);
+			if (length > 0.0) {
+				normal /= length;
+				const Quadric quadric(glm::dvec4(normal, -glm::dot(normal, p0)), _borderWeight);
+				_quadrics[edges[i].a] += quadric;
+				_quadrics[edges[i].b] += quadric;
+			}
+		}
+	}
+
+	for (size_t i = 0; i < edges.size(); ++i) {
+		if (i == 0 || edges[i - 1].a != edges[i].a || edges[i - 1].b != edges[i].b) {
+			_queueEdge(edges[i].a, edges[i].b);
+		}
+	}
+}
+
+
+/*
+ * @brief collapse edges until at most targetCount triangles are left
+ * @return false if no edge can be collapsed any more
+ */
+bool MeshSimplifier::simplify(uint32_t targetCount) {
+	while (_triangleCount > targetCount && !_collapses.empty()) {
+		const Collapse collapse = _collapses.top();
+		_collapses.pop();
+
+		if (_removedVertices[collapse.from] || _removedVertices[collapse.to] ||
+			_versions[collapse.from] != collapse.fromVersion || _versions[collapse.to] != collapse.toVersion) {
+			continue;
+		}
+
+		if (!_keepsManifold(collapse.from, collapse.to) ||
+			_flips(collapse.from, collapse.to, collapse.position) ||
+			_flips(collapse.to, collapse.from, collapse.position)) {
+			continue;
+		}
+
+		_collapse(collapse);
+	}
+
+	return _triangleCount <= targetCount;
+}
+
+
+uint32_t MeshSimplifier::getTriangleCount() const {
+	return _triangleCount;
+}
+
+
+/*
+ * @brief get the largest distance error of the collapses so far,
+ *        the root of the largest quadric error
+ */
+float MeshSimplifier::getError() const {
+	return static_cast<float>(std::sqrt(_maxCost));
+}
+
+
+/*
+ * @brief append the current triangles with smooth normals
+ */
+void MeshSimplifier::getTriangles(std::vector<Triangle>& triangles) const {
+	std::vector<glm::vec3> normals(_positions.size(), glm::vec3(0.0f));
+	for (size_t t = 0; t < _removedTriangles.size(); ++t) {
+		if (_removedTriangles[t]) {
+			continue;
+		}
+
+		const uint32_t* v = &_indices[3 * t];
+		// area weighted, the cross product is twice the area
+		const glm::vec3 normal = glm::cross(
+			_positions[v[1]] - _positions[v[0]], _positions[v[2]] - _positions[v[0]]);
+		for (int j = 0; j < 3; ++j) {
+			normals[v[j]] += normal;
+		}
+	}
+
+	triangles.reserve(triangles.size() + _triangleCount);
+	for (size_t t = 0; t < _removedTriangles.size(); ++t) {
+		if (_removedTriangles[t]) {
+			continue;
+		}
+
+		Triangle triangle;
+		for (int j = 0; j < 3; ++j) {
+			const uint32_t v = _indices[3 * t + j];
+			const float length = glm::length(normals[v]);
+			triangle.v[j].position = _positions[v];
+			triangle.v[j].normal = length > 0.0f ? normals[v] / length : glm::vec3(0.0f);
+			triangle.v[j].uv = glm::vec2(0.0f);
+		}
+		triangles.push_back(triangle);
+	}
+}
+
+
+/*
+ * @brief queue the collapses of all edges around a vertex
+ */
+void MeshSimplifier::_queueEdges(uint32_t vertex) {
+	// an interior edge shows up in two triangles, queued twice it is collapsed once
+	for (uint32_t t : _vertexTriangles[vertex]) {
+		const uint32_t* v = &_indices[3 * t];
+		for (int j = 0; j < 3; ++j) {
+			if (v[j] != vertex) {
+				_queueEdge(vertex, v[j]);
+			}
+		}
+	}
+}
+
+
+/*
+ * @brief queue the collapse of an edge to the position of the least error
+ */
+void MeshSimplifier::_queueEdge(uint32_t from, uint32_t to) {
+	Quadric quadric = _quadrics[from];
+	quadric += _quadrics[to];
+
+	const glm::dvec3 p0 = _positions[from], p1 = _positions[to];
+	glm::dvec3 position;
+	double cost;
+	// the optimum of a nearly singular quadric may lie far off, keep it near the edge
+	if (quadric.getOptimum(position) &&
+		glm::length(position - 0.5 * (p0 + p1)) <= glm::length(p1 - p0)) {
+		cost = quadric.evaluate(position);
+	}
+	else {
+		const glm::dvec3 candidates[3] = { p0, p1, 0.5 * (p0 + p1) };
+		position = candidates[0];
+		cost = quadric.evaluate(candidates[0]);
+		for (int i = 1; i < 3; ++i) {
+			const double candidateCost = quadric.evaluate(candidates[i]);
+			if (candidateCost < cost) {
+				position = candidates[i];
+				cost = candidateCost;
+			}
+		}
+	}
+
+	_collapses.push(Collapse{ std::max(cost, 0.0), from, to,
+		_versions[from], _versions[to], glm::vec3(position) });
+}
+
+
+/*
+ * @brief check the link condition of an edge, the vertices adjacent to both
+ *        ends must be the opposite corners of the triangles of the edge,
+ *        otherwise the collapse pinches the surface
+ */
+bool MeshSimplifier::_keepsManifold(uint32_t from, uint32_t to) const {
+	std::vector<uint32_t>& neighbors = _neighbors;
+	neighbors.clear();
+	for (uint32_t t : _vertexTriangles[from]) {
+		if (_removedTriangles[t]) {
+			continue;
+		}
+
+		const uint32_t* v = &_indices[3 * t];
+		for (int j = 0; j < 3; ++j) {
+			if (v[j] != from) {
+				neighbors.push_back(v[j]);
+			}
+		}
+	}
+	std::sort(neighbors.begin(), neighbors.end());
+	neighbors.erase(std::unique(neighbors.begin(), neighbors.end()), neighbors.end());
+
+	uint32_t edgeTriangleCount = 0;
+	uint32_t commonCount = 0;
+	uint32_t previous = to;
+	std::vector<uint32_t>& others = _otherNeighbors;
+	others.clear();
+	for (uint32_t t : _vertexTriangles[to]) {
+		if (_removedTriangles[t]) {
+			continue;
+		}
+
+		const uint32_t* v = &_indices[3 * t];
+		if (v[0] == from || v[1] == from || v[2] == from) {
+			++edgeTriangleCount;
+		}
+
+		for (int j = 0; j < 3; ++j) {
+			if (v[j] != to && v[j] != from) {
+				others.push_back(v[j]);
+			}
+		}
+	}
+	std::sort(others.begin(), others.end());
+	for (uint32_t v : others) {
+		if (v != previous && std::binary_search(neighbors.begin(), neighbors.end(), v)) {
+			++commonCount;
+		}
+		previous = v;
+	}
+
+	return commonCount <= edgeTriangleCount;
+}
+
+
+/*
+ * @brief check if moving a vertex to position flips or degenerates one of its
+ *        triangles that the collapse with other keeps
+ */
+bool MeshSimplifier::_flips(uint32_t vertex, uint32_t other, const glm::vec3& position) const {
+	for (uint32_t t : _vertexTriangles[vertex]) {
+		if (_removedTriangles[t]) {
+			continue;
+		}
+
+		const uint32_t* v = &_indices[3 * t];
+		if (v[0] == other || v[1] == other || v[2] == other) {
+			continue;
+		}
+
+		glm::vec3 p[3], q[3];
+		for (int j = 0; j < 3; ++j) {
+			p[j] = _positions[v[j]];
+			q[j] = v[j] == vertex ? position : p[j];
+		}
+
+		const glm::vec3 before = glm::cross(p[1] - p[0], p[2] - p[0]);
+		const glm::vec3 after = glm::cross(q[1] - q[0], q[2] - q[0]);
+		const float lengths = glm::length(before) * glm::length(after);
+		if (lengths <= 0.0f || glm::dot(before, after) < _minNormalCosine * lengths) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+/*
+ * @brief merge the first vertex of an edge into the second
+ */
+void MeshSimplifier::_collapse(const Collapse& collapse) {
+	const uint32_t from = collapse.from, to = collapse.to;
+
+	_positions[to] = collapse.position;
+	_quadrics[to] += _quadrics[from];
+	_removedVertices[from] = true;
+	++_versions[from];
+	++_versions[to];
+	_maxCost = std::max(_maxCost, collapse.cost);
+
+	for (uint32_t t : _vertexTriangles[from]) {
+		if (_removedTriangles[t]) {
+			continue;
+		}
+
+		uint32_t* v = &_indices[3 * t];
+		if (v[0] == to || v[1] == to || v[2] == to) {
+			_removedTriangles[t] = true;
+			--_triangleCount;
+			continue;
+		}
+
+		for (int j = 0; j < 3; ++j) {
+			if (v[j] == from) {
+				v[j] = to;
+			}
+		}
+		_vertexTriangles[to].push_back(t);
+	}
+	_vertexTriangles[from].clear();
+
+	auto& triangles = _vertexTriangles[to];
+	triangles.erase(std::remove_if(triangles.begin(), triangles.end(), [this](uint32_t t) {
+		return _removedTriangles[t];
+	}), triangles.end());
+
+	_queueEdges(to);
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <cstdint>
+#include <queue>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "mesh.h"
+
+/*
+ * @brief edge collapse simplification with quadric error metrics (Garland and Heckbert)
+ * @detail vertices with the same position are welded first, so the attribute
+ *         seams of the input do not open into cracks. Every vertex sums the
+ *         quadrics of the planes of its triangles, border edges add a plane
+ *         perpendicular to their triangle to keep the outline. The cheapest
+ *         edge is collapsed to the position minimizing the summed quadric
+ *         unless a triangle around it would flip. The quadrics accumulate over
+ *         the whole run, so repeated calls of simplify give a chain of coarser
+ *         meshes with growing errors.
+ */
+class MeshSimplifier {
+public:
+	/*
+	 * @brief constructor
+	 * @param vertices vertices of the mesh, only the positions are used
+	 * @param indices 3 vertex indices per triangle
+	 */
+	MeshSimplifier(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices);
+
+	/*
+	 * @brief collapse edges until at most targetCount triangles are left
+	 * @return false if no edge can be collapsed any more
+	 */
+	bool simplify(uint32_t targetCount);
+
+	uint32_t getTriangleCount() const;
+
+	/*
+	 * @brief get the largest distance error of the collapses so far,
+	 *        the root of the largest quadric error
+	 */
+	float getError() const;
+
+	/*
+	 * @brief append the current triangles with smooth normals
+	 */
+	void getTriangles(std::vector<Triangle>& triangles) const;
+
+private:
+	/* symmetric 4x4 matrix, the upper triangle row by row */
+	struct Quadric {
+		double m[10] = {};
+
+		Quadric() = default;
+
+		Quadric(const glm::dvec4& plane, double weight);
+
+		Quadric& operator+=(const Quadric& other);
+
+		double evaluate(const glm::dvec3& p) const;
+
+		/*
+		 * @brief get the position of the least error
+		 * @return false if the quadric is singular
+		 */
+		bool getOptimum(glm::dvec3& p) const;
+	};
+
+	struct Collapse {
+		double cost;
+		uint32_t from, to;
+		/* versions of both vertices when queued, stale once either changes */
+		uint32_t fromVersion, toVersion;
+		glm::vec3 position;
+
+		bool operator>(const Collapse& other) const {
+			return cost > other.cost;
+		}
+	};
+
+	std::vector<glm::vec3> _positions;
+
+	std::vector<Quadric> _quadrics;
+
+	/* bumped whenever a vertex moves or loses a triangle */
+	std::vector<uint32_t> _versions;
+
+	std::vector<bool> _removedVertices;
+
+	/* 3 welded vertex indices per triangle */
+	std::vector<uint32_t> _indices;
+
+	std::vector<bool> _removedTriangles;
+
+	/* triangles around every vertex, removed ones are dropped lazily */
+	std::vector<std::vector<uint32_t>> _vertexTriangles;
+
+	std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>> _collapses;
+
+	uint32_t _triangleCount = 0;
+
+	double _maxCost = 0.0;
+
+	/* scratch of the link condition */
+	mutable std::vector<uint32_t> _neighbors, _otherNeighbors;
+
+	/* weight of the planes keeping the border, relative to the triangle planes */
+	static constexpr double _borderWeight = 100.0;
+
+	/* smallest cosine between the old and the new normal of a moved triangle */
+	static constexpr float _minNormalCosine = 0.2f;
+
+	void _queueEdges(uint32_t vertex);
+
+	void _queueEdge(uint32_t from, uint32_t to);
+
+	bool _keepsManifold(uint32_t from, uint32_t to) const;
+
+	bool _flips(uint32_t vertex, uint32_t other, const glm::vec3& position) const;
+
+	void _collapse(const Collapse& collapse);
+};
@@ -1,11 +1,32 @@
 #include "octree.h"
 
-Octree::Octree(std::vector<Triangle>* _triangles, size_t Threshold) {
+Octree::Octree(const std::vector<Triangle>* _triangles, size_t Threshold) {
 	objects = _triangles;
 	threshold = Threshold;
-	root = new OctreeNode(1);
+	// the root lives in the map as the other nodes, see lookupNode
+	root = &nodes[1];
+	root->locCode = 1;
 	buildBoundingBox();
 	buildOctree();
+
+	triangleNodes.resize(objects->size());
+	for (const auto& node : nodes) {
+		for (const Triangle* triangle : node.second.objects) {
+			triangleNodes[triangle - objects->data()] = node.first;
+		}
+	}
+	refit();
+
+	uint32_t index = 0;
+	indexSubtree(root, index);
+
+	memory.resize(nodes.size() * sizeof(OctBoundingBox) + triangleNodes.capacity() * sizeof(uint32_t));
+}
+
+Octree::~Octree() {
+	for (auto& node : nodes) {
+		delete node.second.box;
+	}
 }
 
 void Octree::buildBoundingBox() {
@@ -30,7 +51,6 @@ void Octree::buildBoundingBox() {
 }
 
 void Octree::buildOctree() {
-	nodes[root->locCode] = *root;
 	splitNode(root, 0);
 }
 
@@ -55,14 +75,14 @@ void Octree::splitNode(OctreeNode* node, int depth) {
 			const uint32_t locCodeChild = (node->locCode << 3) | locCodeTemp[0];
 			if (!(node->childExists&(1 << locCodeTemp[0]))) {
 				node->childExists |= 1 << (locCodeTemp[0]);
-				auto childNode = new OctreeNode(locCodeChild);
+				OctreeNode childNode(locCodeChild);
 				glm::vec3 childCenter;
 				float halfHalfSide = halfSide * 0.5f;
-				childCenter.x = center.x + (locCodeTemp[0] & 4) ? halfHalfSide : -halfHalfSide;
-				childCenter.y = center.y + (locCodeTemp[0] & 2) ? halfHalfSide : -halfHalfSide;
-				childCenter.z = center.z + (locCodeTemp[0] & 1) ? halfHalfSide : -halfHalfSide;
-				childNode->box = new OctBoundingBox{childCenter, halfHalfSide };
-				nodes[childNode->locCode] = *childNode;
+				childCenter.x = center.x + ((locCodeTemp[0] & 4) ? halfHalfSide : -halfHalfSide);
+				childCenter.y = center.y + ((locCodeTemp[0] & 2) ? halfHalfSide : -halfHalfSide);
+				childCenter.z = center.z + ((locCodeTemp[0] & 1) ? halfHalfSide : -halfHalfSide);
+				childNode.box = new OctBoundingBox{childCenter, halfHalfSide };
+				nodes[childNode.locCode] = std::move(childNode);
 			}
 			// assign the triangle
 			auto *child = lookupNode(locCodeChild);
@@ -97,4 +117,73 @@ size_t Octree::getNodeTreeDepth(const OctreeNode* node) {
 	int depth = 0;
 	for (uint32_t lc = node->locCode; lc > 1; lc >>= 3, ++depth);
 	return depth;
-}
\ No newline at end of file
+}
+
+const OctreeNode* Octree::findNode(uint32_t locCode) const {
+	auto iter = nodes.find(locCode);
+	return iter != nodes.end() ? &iter->second : nullptr;
+}
+
+void Octree::refit() {
+	refitSubtree(root);
+}
+
+void Octree::refit(const std::vector<uint32_t>& triangleIndices) {
+	std::vector<uint32_t> dirty;
+	for (uint32_t index : triangleIndices) {
+		for (uint32_t lc = triangleNodes[index]; lc >= 1; lc >>= 3) {
+			dirty.push_back(lc);
+		}
+	}
+
+	// a deeper location code is larger, so the children come before their parents
+	std::sort(dirty.begin(), dirty.end(), std::greater<uint32_t>());
+	dirty.erase(std::unique(dirty.begin(), dirty.end()), dirty.end());
+	for (uint32_t lc : dirty) {
+		refitNode(lookupNode(lc));
+	}
+}
+
+void Octree::refitNode(OctreeNode* node) {
+	node->minPoint = glm::vec3(std::numeric_limits<float>::max());
+	node->maxPoint = glm::vec3(std::numeric_limits<float>::lowest());
+	node->normal = glm::vec3(0.0f);
+	for (const Triangle* triangle : node->objects) {
+		for (int i = 0; i < 3; ++i) {
+			node->minPoint = glm::min(node->minPoint, triangle->v[i].position);
+			node->maxPoint = glm::max(node->maxPoint, triangle->v[i].position);
+		}
+		// the triangles are shaded with the normal of their first vertex
+		const float area = 0.5f * glm::length(glm::cross(
+			triangle->v[1].position - triangle->v[0].position,
+			triangle->v[2].position - triangle->v[0].position));
+		node->normal += area * triangle->v[0].normal;
+	}
+
+	for (int i = 0; i < 8; ++i) {
+		if (node->childExists & (1 << i)) {
+			const OctreeNode* child = lookupNode((node->locCode << 3) | i);
+			node->minPoint = glm::min(node->minPoint, child->minPoint);
+			node->maxPoint = glm::max(node->maxPoint, child->maxPoint);
+			node->normal += child->normal;
+		}
+	}
+}
+
+void Octree::refitSubtree(OctreeNode* node) {
+	for (int i = 0; i < 8; ++i) {
+		if (node->childExists & (1 << i)) {
+			refitSubtree(lookupNode((node->locCode << 3) | i));
+		}
+	}
+	refitNode(node);
+}
+
+void Octree::indexSubtree(OctreeNode* node, uint32_t& index) {
+	node->index = index++;
+	for (int i = 0; i < 8; ++i) {
+		if (node->childExists & (1 << i)) {
+			indexSubtree(lookupNode((node->locCode << 3) | i), index);
+		}
+	}
+}
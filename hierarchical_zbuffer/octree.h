@@ -1,11 +1,17 @@
 #pragma once
 
 #include <algorithm>
+#include <cfloat>
+#include <functional>
+#include <limits>
 #include <unordered_map>
 #include <unordered_set>
 #include <stack>
 #include <iostream>
 
+#include <glm/glm.hpp>
+
+#include "core/memory_tracker.h"
 #include "mesh.h"
 
 struct OctBoundingBox {
@@ -16,9 +22,17 @@ struct OctBoundingBox {
 class OctreeNode {
 public:
 	OctBoundingBox* box = nullptr;
-	std::unordered_set<Triangle*> objects;
+	std::unordered_set<const Triangle*, std::hash<const Triangle*>, std::equal_to<const Triangle*>,
+		TrackingAllocator<const Triangle*, MemoryTag::Octree>> objects;
 	uint32_t locCode = std::numeric_limits<uint32_t>::max();
 	uint8_t childExists = 0;
+	/* position in depth first order, below getNodeCount */
+	uint32_t index = 0;
+	/* tight bounds of the triangles in the subtree, may leave box after a refit */
+	glm::vec3 minPoint = glm::vec3(std::numeric_limits<float>::max());
+	glm::vec3 maxPoint = glm::vec3(std::numeric_limits<float>::lowest());
+	/* area weighted sum of the shading normals in the subtree, the normal of a splat */
+	glm::vec3 normal = glm::vec3(0.0f);
 	OctreeNode() = default;
 	OctreeNode(uint32_t LocCode) : locCode(LocCode) { };
 };
@@ -26,14 +40,36 @@ public:
 struct OctreeZNode {
 	bool isLeaf;
 	float z = -1.0f;
-	OctreeNode* node = nullptr;
+	const OctreeNode* node = nullptr;
+	/* frustum planes the box of the node crosses, see Frustum::intersectsBox */
+	uint8_t planeMask = 0;
+	/* nearest depth of the box of this node and of the nodes below it on the stack */
+	float stackMinZ = -1.0f;
 };
 
 typedef OctreeZNode* ptrOctreeZNode;
 
 class Octree {
 public:
-	Octree(std::vector<Triangle>* _triangles, size_t Threshold);
+	/* per frame counters of the traversal */
+	struct Statistics {
+		/* nodes whose box was tested */
+		uint32_t visited = 0;
+		/* nodes outside of the view frustum, skipped with their subtrees */
+		uint32_t frustum = 0;
+		/* nodes inside of all frustum planes, their subtrees skip the frustum tests */
+		uint32_t inside = 0;
+		/* nodes whose triangles are behind the hierarchical zbuffer */
+		uint32_t occluded = 0;
+		/* nodes outside of the potentially visible set of the camera cell */
+		uint32_t potentiallyVisible = 0;
+		/* subtrees left on the stack when the screen was covered in front of them */
+		uint32_t covered = 0;
+		/* subtrees drawn as a splat instead of their triangles */
+		uint32_t splatted = 0;
+	};
+
+	Octree(const std::vector<Triangle>* _triangles, size_t Threshold);
 	
 	~Octree();
 	
@@ -45,13 +81,42 @@ public:
 
 	OctreeNode* getParentNode(OctreeNode* node);
 	OctreeNode* lookupNode(uint32_t locCode);
+	/* null if the node does not exist */
+	const OctreeNode* findNode(uint32_t locCode) const;
 	size_t getNodeTreeDepth(const OctreeNode* node);
+	/* the nodes are indexed in depth first order, the same for the same triangles */
+	uint32_t getNodeCount() const { return static_cast<uint32_t>(nodes.size()); }
 
 	OctreeNode* getRoot() { return root; }
+	const OctreeNode* getRoot() const { return root; }
+
+	/*
+	 * @brief recompute the tight bounds of all nodes from their triangles
+	 */
+	void refit();
+
+	/*
+	 * @brief recompute the tight bounds after some triangles moved
+	 * @detail only the nodes holding the triangles and their ancestors are
+	 *         visited. The triangles stay in their nodes, a triangle moved
+	 *         out of the box of its node widens the bounds instead.
+	 * @param triangleIndices indices of the moved triangles in the vector
+	 *        the octree was built from
+	 */
+	void refit(const std::vector<uint32_t>& triangleIndices);
 
 private:
 	OctreeNode* root = nullptr;
-	std::unordered_map<uint32_t, OctreeNode> nodes;
-	std::vector<Triangle>* objects = nullptr;
+	std::unordered_map<uint32_t, OctreeNode, std::hash<uint32_t>, std::equal_to<uint32_t>,
+		TrackingAllocator<std::pair<const uint32_t, OctreeNode>, MemoryTag::Octree>> nodes;
+	/* the bounding boxes, the nodes and their triangles are tracked by the containers */
+	MemoryRegistration memory{ MemoryTag::Octree };
+	const std::vector<Triangle>* objects = nullptr;
 	size_t threshold = 10;
+	/* location code of the node of every triangle */
+	std::vector<uint32_t> triangleNodes;
+
+	void refitNode(OctreeNode* node);
+	void refitSubtree(OctreeNode* node);
+	void indexSubtree(OctreeNode* node, uint32_t& index);
 };
\ No newline at end of file
@@ -0,0 +1,125 @@
+#include <algorithm>
+#include <iostream>
+
+#include <glm/glm.hpp>
+#include <stb_image_write.h>
+
+#include "overdraw.h"
+
+
+double OverdrawCounters::Statistics::getDepthComplexity() const {
+	return coveredPixels > 0 ? static_cast<double>(tests) / coveredPixels : 0.0;
+}
+
+
+double OverdrawCounters::Statistics::getOverdraw() const {
+	return coveredPixels > 0 ? static_cast<double>(writes) / coveredPixels : 0.0;
+}
+
+
+/*
+ * @brief allocate the counters of a width x height image
+ */
+void OverdrawCounters::resize(int width, int height) {
+	_width = width;
+	_height = height;
+
+	const size_t resolution = static_cast<size_t>(width) * height;
+	_tests.assign(resolution, 0);
+	_passes.assign(resolution, 0);
+	_writes.assign(resolution, 0);
+}
+
+
+/*
+ * @brief reset the counters for a new frame
+ */
+void OverdrawCounters::clear() {
+	std::fill(_tests.begin(), _tests.end(), 0);
+	std::fill(_passes.begin(), _passes.end(), 0);
+	std::fill(_writes.begin(), _writes.end(), 0);
+}
+
+
+/*
+ * @brief get the totals and histograms of the counters
+ */
+OverdrawCounters::Statistics OverdrawCounters::getStatistics() const {
+	Statistics statistics;
+	for (size_t i = 0; i < _tests.size(); ++i) {
+		statistics.tests += _tests[i];
+		statistics.passes += _passes[i];
+		statistics.writes += _writes[i];
+
+		// a pixel written without a test, e.g. by a resolve pass, is covered too
+		if (_tests[i] > 0 || _writes[i] > 0) {
+			++statistics.coveredPixels;
+			++statistics.testHistogram[std::min<uint32_t>(_tests[i], Statistics::binCount - 1)];
+			++statistics.writeHistogram[std::min<uint32_t>(_writes[i], Statistics::binCount - 1)];
+		}
+	}
+
+	return statistics;
+}
+
+
+/*
+ * @brief write a counter as a png heatmap, top down
+ * @param maxCount count mapped to the hottest color, 0 for the maximum of the frame
+ * @return true on success
+ */
+bool OverdrawCounters::writeHeatmap(const std::string& filepath, enum Counter counter, uint32_t maxCount) const {
+	const std::vector<uint32_t>& counts =
+		counter == Counter::Test ? _tests : (counter == Counter::Pass ? _passes : _writes);
+
+	if (maxCount == 0) {
+		maxCount = std::max<uint32_t>(1, counts.empty() ? 1 : *std::max_element(counts.begin(), counts.end()));
+	}
+
+	// black for untouched pixels, then blue, green, yellow and red
+	static const glm::vec3 ramp[] = {
+		{ 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 1.0f }, { 0.0f, 1.0f, 0.0f }, { 1.0f, 1.0f, 0.0f }, { 1.0f, 0.0f, 0.0f }
+	};
+	constexpr int rampSize = sizeof(ramp) / sizeof(ramp[0]);
+
+	std::vector<uint8_t> rgb(static_cast<size_t>(_width) * _height * 3);
+	for (int y = 0; y < _height; ++y) {
+		const uint32_t* src = counts.data() + static_cast<size_t>(_height - 1 - y) * _width;
+		uint8_t* dst = rgb.data() + static_cast<size_t>(y) * _width * 3;
+		for (int x = 0; x < _width; ++x) {
+			const float t = std::min(1.0f, 1.0f * src[x] / maxCount) * (rampSize - 1);
+			const int i = std::min(static_cast<int>(t), rampSize - 2);
+			const glm::vec3 color = glm::mix(ramp[i], ramp[i + 1], t - i);
+			dst[3 * x] = static_cast<uint8_t>(255 * color.r);
+			dst[3 * x + 1] = static_cast<uint8_t>(255 * color.g);
+			dst[3 * x + 2] = static_cast<uint8_t>(255 * color.b);
+		}
+	}
+
+	return stbi_write_png(filepath.c_str(), _width, _height, 3, rgb.data(), _width * 3) != 0;
+}
+
+
+/*
+ * @brief print the statistics of a frame
+ */
+void OverdrawCounters::print(const Statistics& statistics) {
+	std::cout << "+ depth tests: " << statistics.tests
+		<< ", passes: " << statistics.passes
+		<< ", writes: " << statistics.writes
+		<< ", covered pixels: " << statistics.coveredPixels << "\n";
+	std::cout << "+ depth complexity: " << statistics.getDepthComplexity()
+		<< ", overdraw: " << statistics.getOverdraw() << "\n";
+
+	std::cout << "+ pixels by tests:";
+	for (int i = 0; i < Statistics::binCount; ++i) {
+		std::cout << " " << statistics.testHistogram[i];
+	}
+
+	std::cout << "\n+ pixels by writes:";
+	for (int i = 0; i < Statistics::binCount; ++i) {
+		std::cout << " " << statistics.writeHistogram[i];
+	}
+
+	std::cout << std::endl;
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+//#define ENABLE_OVERDRAW_STATISTICS
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+ * @brief per pixel counters of depth tests, depth passes and framebuffer writes
+ * @detail the rasterizers count through the OVERDRAW_COUNT_* macros, which
+ *         compile to nothing unless ENABLE_OVERDRAW_STATISTICS is defined
+ */
+class OverdrawCounters {
+public:
+	enum class Counter {
+		Test, Pass, Write
+	};
+
+	struct Statistics {
+		static constexpr int binCount = 16;
+
+		uint64_t tests = 0;
+		uint64_t passes = 0;
+		uint64_t writes = 0;
+		/* pixels tested or written at least once */
+		uint64_t coveredPixels = 0;
+		/* covered pixels by count, the last bin holds binCount - 1 or more */
+		uint64_t testHistogram[binCount] = {};
+		uint64_t writeHistogram[binCount] = {};
+
+		/* average depth tests per covered pixel */
+		double getDepthComplexity() const;
+
+		/* average framebuffer writes per covered pixel */
+		double getOverdraw() const;
+	};
+
+	/*
+	 * @brief allocate the counters of a width x height image
+	 */
+	void resize(int width, int height);
+
+	/*
+	 * @brief reset the counters for a new frame
+	 */
+	void clear();
+
+	/*
+	 * @brief increment a counter of a pixel, no op without counters
+	 */
+	static void count(OverdrawCounters* counters, enum Counter counter, int index) {
+		if (counters != nullptr) {
+			switch (counter) {
+			case Counter::Test:
+				++counters->_tests[index];
+				break;
+			case Counter::Pass:
+				++counters->_passes[index];
+				break;
+			case Counter::Write:
+				++counters->_writes[index];
+				break;
+			}
+		}
+	}
+
+	/*
+	 * @brief get the totals and histograms of the counters
+	 */
+	Statistics getStatistics() const;
+
+	/*
+	 * @brief write a counter as a png heatmap, top down
+	 * @param maxCount count mapped to the hottest color, 0 for the maximum of the frame
+	 * @return true on success
+	 */
+	bool writeHeatmap(const std::string& filepath, enum Counter counter, uint32_t maxCount = 0) const;
+
+	/*
+	 * @brief print the statistics of a frame
+	 */
+	static void print(const Statistics& statistics);
+
+private:
+	int _width = 0, _height = 0;
+
+	/* rows bottom up as in Framebuffer */
+	std::vector<uint32_t> _tests;
+	std::vector<uint32_t> _passes;
+	std::vector<uint32_t> _writes;
+};
+
+#ifdef ENABLE_OVERDRAW_STATISTICS
+	#define OVERDRAW_COUNT_TEST(counters, index) \
+		OverdrawCounters::count((counters), OverdrawCounters::Counter::Test, (index))
+	#define OVERDRAW_COUNT_PASS(counters, index) \
+		OverdrawCounters::count((counters), OverdrawCounters::Counter::Pass, (index))
+	#define OVERDRAW_COUNT_WRITE(counters, index) \
+		OverdrawCounters::count((counters), OverdrawCounters::Counter::Write, (index))
+#else
+	#define OVERDRAW_COUNT_TEST(counters, index) ((void)0)
+	#define OVERDRAW_COUNT_PASS(counters, index) ((void)0)
+	#define OVERDRAW_COUNT_WRITE(counters, index) ((void)0)
+#endif
@@ -0,0 +1,282 @@
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "scanline_renderer.h"
+#include "fps_camera.h"
+#include "potentially_visible_set.h"
+
+namespace {
+	/* start of a file written by save */
+	constexpr char fileMagic[4] = { 'P', 'V', 'S', '1' };
+
+	template <typename T>
+	void writeValues(std::ofstream& file, const T* values, size_t count) {
+		file.write(reinterpret_cast<const char*>(values), count * sizeof(T));
+	}
+
+	template <typename T>
+	void readValues(std::ifstream& file, T* values, size_t count) {
+		file.read(reinterpret_cast<char*>(values), count * sizeof(T));
+	}
+}
+
+
+/*
+ * @brief render the sample views of every cell and record the visible nodes
+ * @detail a sample renders the six faces of a cube map with the octree mode
+ *         of a renderer of its own, which builds the same octree from the
+ *         same triangles and records the nodes it would draw
+ * @param triangles triangles of the octree the set is used with
+ */
+void PotentiallyVisibleSet::build(const Options& options, std::vector<Triangle>& triangles) {
+	_minPoint = options.minPoint;
+	_cellCount = glm::max(options.cellCount, glm::ivec3(1));
+	_cellSize = (options.maxPoint - options.minPoint) / glm::vec3(_cellCount);
+	_cellOffsets.assign(1, 0);
+	_runs.clear();
+
+	Framebuffer framebuffer(options.resolution, options.resolution);
+	ScanlineRenderer renderer(framebuffer, options.resolution, options.resolution,
+		triangles, glm::vec4(0.0f));
+	renderer.setRenderMode(ScanlineRenderer::RenderMode::OctreeHierarchicalZBuffer);
+	// a sample inside of the geometry would rasterize huge unclipped triangles,
+	// culling them only lets more nodes pass
+	renderer.getCuller().setCullNearPlane(true);
+	// the visible nodes only depend on the depth
+	renderer.setDepthOnly(true);
+
+	std::vector<bool> visibleNodes;
+	renderer.setVisibleNodeRecord(&visibleNodes);
+	_nodeCount = static_cast<uint32_t>(visibleNodes.size());
+
+	// the view matrix applies the rotation of the camera, each one turns a face to -z
+	const glm::quat faces[6] = {
+		glm::quat(1.0f, 0.0f, 0.0f, 0.0f),
+		glm::angleAxis(glm::pi<float>(), glm::vec3(0.0f, 1.0f, 0.0f)),
+		glm::angleAxis(glm::half_pi<float>(), glm::vec3(0.0f, 1.0f, 0.0f)),
+		glm::angleAxis(-glm::half_pi<float>(), glm::vec3(0.0f, 1.0f, 0.0f)),
+		glm::angleAxis(glm::half_pi<float>(), glm::vec3(1.0f, 0.0f, 0.0f)),
+		glm::angleAxis(-glm::half_pi<float>(), glm::vec3(1.0f, 0.0f, 0.0f)),
+	};
+
+	FpsCamera camera(glm::half_pi<float>(), 1.0f, options.nearClip, options.farClip);
+	// the octree mode takes the triangles, not the models
+	const std::vector<Model> models;
+	const glm::vec3 color(1.0f);
+
+	for (int z = 0; z < _cellCount.z; ++z) {
+		for (int y = 0; y < _cellCount.y; ++y) {
+			for (int x = 0; x < _cellCount.x; ++x) {
+				const glm::vec3 cellMin = _minPoint + _cellSize * glm::vec3(x, y, z);
+				std::fill(visibleNodes.begin(), visibleNodes.end(), false);
+
+				// the 8 corners and the center
+				for (int sample = 0; sample < 9; ++sample) {
+					const glm::vec3 offset = sample < 8 ?
+						glm::vec3(sample & 1, (sample >> 1) & 1, (sample >> 2) & 1) : glm::vec3(0.5f);
+					camera.setLocalPosition(cellMin + _cellSize * offset);
+					for (const auto& face : faces) {
+						camera.setLocalRotation(face);
+						renderer.render(framebuffer, camera, models, color, color, glm::vec3(0.0f, 0.0f, 1.0f));
+					}
+				}
+
+				_encode(visibleNodes);
+			}
+		}
+	}
+
+	_memory.resize(_cellOffsets.capacity() * sizeof(uint32_t) + _runs.capacity() * sizeof(uint16_t));
+}
+
+
+/*
+ * @brief write the set to a binary file
+ * @exception std::runtime_error if the file cannot be written
+ */
+void PotentiallyVisibleSet::save(const std::string& filepath) const {
+	std::ofstream file(filepath, std::ios::binary);
+	if (!file) {
+		throw std::runtime_error("cannot write " + filepath);
+	}
+
+	const uint32_t runCount = static_cast<uint32_t>(_runs.size());
+	writeValues(file, fileMagic, 4);
+	writeValues(file, &_minPoint.x, 3);
+	writeValues(file, &_cellSize.x, 3);
+	writeValues(file, &_cellCount.x, 3);
+	writeValues(file, &_nodeCount, 1);
+	writeValues(file, &runCount, 1);
+	writeValues(file, _cellOffsets.data(), _cellOffsets.size());
+	writeValues(file, _runs.data(), _runs.size());
+
+	if (!file) {
+		throw std::runtime_error("cannot write " + filepath);
+	}
+}
+
+
+/*
+ * @brief read a set written by save
+ * @exception std::runtime_error if the file cannot be read
+ */
+void PotentiallyVisibleSet::load(const std::string& filepath) {
+	std::ifstream file(filepath, std::ios::binary);
+	if (!file) {
+		throw std::runtime_error("cannot read " + filepath);
+	}
+
+	char magic[4] = {};
+	readValues(file, magic, 4);
+	if (!file || !std::equal(magic, magic + 4, fileMagic)) {
+		throw std::runtime_error(filepath + " is no potentially visible set");
+	}
+
+	uint32_t runCount = 0;
+	readValues(file, &_minPoint.x, 3);
+	readValues(file, &_cellSize.x, 3);
+	readValues(file, &_cellCount.x, 3);
+	readValues(file, &_nodeCount, 1);
+	readValues(file, &runCount, 1);
+	if (!file || glm::any(glm::lessThan(_cellCount, glm::ivec3(1)))) {
+		throw std::runtime_error("cannot read " + filepath);
+	}
+
+	// a rejected file leaves an empty set, getCell finds no cell
+	auto reject = [&]() {
+		_cellOffsets.clear();
+		_runs.clear();
+		return std::runtime_error("cannot read " + filepath);
+	};
+
+	_cellOffsets.resize(getCellCount() + 1);
+	_runs.resize(runCount);
+	readValues(file, _cellOffsets.data(), _cellOffsets.size());
+	readValues(file, _runs.data(), _runs.size());
+	if (!file || _cellOffsets.front() != 0 || _cellOffsets.back() != runCount) {
+		throw reject();
+	}
+
+	// the runs of every cell have to cover the nodes exactly, see getVisibleNodes
+	for (int cell = 0; cell < getCellCount(); ++cell) {
+		if (_cellOffsets[cell] > _cellOffsets[cell + 1]) {
+			throw reject();
+		}
+
+		uint64_t nodeCount = 0;
+		for (uint32_t i = _cellOffsets[cell]; i < _cellOffsets[cell + 1]; ++i) {
+			nodeCount += _runs[i];
+		}
+		if (nodeCount != _nodeCount) {
+			throw reject();
+		}
+	}
+
+	_memory.resize(_cellOffsets.capacity() * sizeof(uint32_t) + _runs.capacity() * sizeof(uint16_t));
+}
+
+
+/*
+ * @brief get the cell containing a position
+ * @return -1 outside of the region
+ */
+int PotentiallyVisibleSet::getCell(const glm::vec3& position) const {
+	if (_cellOffsets.empty()) {
+		return -1;
+	}
+
+	const glm::ivec3 cell = glm::ivec3(glm::floor((position - _minPoint) / _cellSize));
+	if (glm::any(glm::lessThan(cell, glm::ivec3(0))) || glm::any(glm::greaterThanEqual(cell, _cellCount))) {
+		return -1;
+	}
+
+	return (cell.z * _cellCount.y + cell.y) * _cellCount.x + cell.x;
+}
+
+
+int PotentiallyVisibleSet::getCellCount() const {
+	return _cellCount.x * _cellCount.y * _cellCount.z;
+}
+
+
+/*
+ * @brief get the nodes of the octree the set was built for
+ */
+uint32_t PotentiallyVisibleSet::getNodeCount() const {
+	return _nodeCount;
+}
+
+
+/*
+ * @brief decode the nodes of a cell, indexed as OctreeNode::index
+ */
+void PotentiallyVisibleSet::getVisibleNodes(int cell, std::vector<bool>& visibleNodes) const {
+	visibleNodes.assign(_nodeCount, false);
+
+	uint32_t node = 0;
+	bool visible = false;
+	for (uint32_t i = _cellOffsets[cell]; i < _cellOffsets[cell + 1]; ++i) {
+		if (visible) {
+			std::fill(visibleNodes.begin() + node, visibleNodes.begin() + node + _runs[i], true);
+		}
+		node += _runs[i];
+		visible = !visible;
+	}
+}
+
+
+uint32_t PotentiallyVisibleSet::getVisibleNodeCount(int cell) const {
+	uint32_t count = 0;
+	for (uint32_t i = _cellOffsets[cell] + 1; i < _cellOffsets[cell + 1]; i += 2) {
+		count += _runs[i];
+	}
+
+	return count;
+}
+
+
+/*
+ * @brief get the bytes of the runs of all cells
+ */
+size_t PotentiallyVisibleSet::getEncodedBytes() const {
+	return _runs.size() * sizeof(uint16_t);
+}
+
+
+/*
+ * @brief append the runs of a cell
+ */
+void PotentiallyVisibleSet::_encode(const std::vector<bool>& visibleNodes) {
+	bool visible = false;
+	uint32_t length = 0;
+	for (bool node : visibleNodes) {
+		if (node != visible) {
+			_appendRun(length);
+			visible = node;
+			length = 0;
+		}
+		++length;
+	}
+
+	_appendRun(length);
+	_cellOffsets.push_back(static_cast<uint32_t>(_runs.size()));
+}
+
+
+/*
+ * @brief append a run, a longer one than 16 bits continues after an
+ *        empty run of the other value
+ */
+void PotentiallyVisibleSet::_appendRun(uint32_t length) {
+	while (length > 0xffff) {
+		_runs.push_back(0xffff);
+		_runs.push_back(0);
+		length -= 0xffff;
+	}
+
+	_runs.push_back(static_cast<uint16_t>(length));
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "core/memory_tracker.h"
+
+#include "mesh.h"
+
+/*
+ * @brief octree nodes seen from each cell of the region the camera moves in
+ * @detail the region is split into a grid of cells. For every cell the
+ *         octree mode renders cube maps from the corners and the center of
+ *         the cell and records the nodes whose boxes pass the frustum and the
+ *         hierarchical zbuffer tests, together with their ancestors. A node
+ *         seen only between the samples may be missed, a finer grid or a
+ *         higher resolution trades build time for it. The nodes of a cell
+ *         are stored as runs of alternating invisible and visible nodes in
+ *         depth first order, starting with the invisible ones.
+ */
+class PotentiallyVisibleSet {
+public:
+	struct Options {
+		/* region the camera stays in */
+		glm::vec3 minPoint = glm::vec3(-1.0f);
+		glm::vec3 maxPoint = glm::vec3(1.0f);
+		glm::ivec3 cellCount = glm::ivec3(8, 1, 8);
+		/* edge length in pixels of a cube map face */
+		int resolution = 128;
+		float nearClip = 0.1f;
+		float farClip = 500.0f;
+	};
+
+	/*
+	 * @brief constructor, an empty set, see build and load
+	 */
+	PotentiallyVisibleSet() = default;
+
+	/*
+	 * @brief render the sample views of every cell and record the visible nodes
+	 * @note takes minutes for large scenes
+	 * @param triangles triangles of the octree the set is used with
+	 */
+	void build(const Options& options, std::vector<Triangle>& triangles);
+
+	/*
+	 * @brief write the set to a binary file
+	 * @exception std::runtime_error if the file cannot be written
+	 */
+	void save(const std::string& filepath) const;
+
+	/*
+	 * @brief read a set written by save
+	 * @exception std::runtime_error if the file cannot be read
+	 */
+	void load(const std::string& filepath);
+
+	/*
+	 * @brief get the cell containing a position
+	 * @return -1 outside of the region
+	 */
+	int getCell(const glm::vec3& position) const;
+
+	int getCellCount() const;
+
+	/*
+	 * @brief get the nodes of the octree the set was built for
+	 */
+	uint32_t getNodeCount() const;
+
+	/*
+	 * @brief decode the nodes of a cell, indexed as OctreeNode::index
+	 */
+	void getVisibleNodes(int cell, std::vector<bool>& visibleNodes) const;
+
+	uint32_t getVisibleNodeCount(int cell) const;
+
+	/*
+	 * @brief get the bytes of the runs of all cells
+	 */
+	size_t getEncodedBytes() const;
+
+private:
+	glm::vec3 _minPoint = glm::vec3(0.0f);
+	glm::vec3 _cellSize = glm::vec3(0.0f);
+	glm::ivec3 _cellCount = glm::ivec3(0);
+
+	uint32_t _nodeCount = 0;
+
+	/* first run of every cell, the end of the runs last */
+	std::vector<uint32_t> _cellOffsets;
+
+	/* run lengths of all cells */
+	std::vector<uint16_t> _runs;
+
+	MemoryRegistration _memory{ MemoryTag::VisibleSet };
+
+	/*
+	 * @brief append the runs of a cell
+	 */
+	void _encode(const std::vector<bool>& visibleNodes);
+
+	/*
+	 * @brief append a run, a longer one than 16 bits continues after an
+	 *        empty run of the other value
+	 */
+	void _appendRun(uint32_t length);
+};
@@ -1,20 +1,28 @@
+#include <cfloat>
+#include "core/profiler.h"
 #include "quadtree.h"
 
 /*
  * @brief constructor
  */
-QuadTree::QuadTree(int windowWidth, int windowHeight, Framebuffer* framebuffer)
-	: _windowWidth(windowWidth), _windowHeight(windowHeight), _framebuffer(framebuffer) {
+QuadTree::QuadTree(int windowWidth, int windowHeight, Framebuffer* framebuffer, Culler* culler)
+	: _depthTiles(windowWidth, windowHeight),
+	_windowWidth(windowWidth), _windowHeight(windowHeight),
+	_framebuffer(framebuffer), _culler(culler) {
 	const int resolution = _windowWidth * _windowHeight;
 	_zbuffer = new float[resolution];
+	_triangleIds = new uint32_t[resolution];
 	_indexNodeBuffer = new uint32_t[resolution];
+	_acceptedSpans.resize(_windowHeight);
 
-	for (size_t i = 0; i < resolution; ++i) {
-		_zbuffer[i] = 1.0f;
-	}
-
-	_root = new QuadTreeNode(1);
+	_root = &_nodes[1];
+	_root->locCode = 1;
 	_construct();
+	_selectRasterKernels();
+
+	_memory.resize(resolution * sizeof(uint32_t) + _nodes.size() * sizeof(QuadBoundingBox) +
+		_acceptedSpans.capacity() * sizeof(std::pair<int, int>));
+	_depthMemory.resize(resolution * (sizeof(float) + sizeof(uint32_t)));
 }
 
 
@@ -28,30 +36,37 @@ QuadTree::~QuadTree() {
 	}
 
 	if (_zbuffer) {
-		delete _zbuffer;
+		delete[] _zbuffer;
 		_zbuffer = nullptr;
 	}
 
+	if (_triangleIds) {
+		delete[] _triangleIds;
+		_triangleIds = nullptr;
+	}
+
 	if (_indexNodeBuffer) {
-		delete _indexNodeBuffer;
+		delete[] _indexNodeBuffer;
 		_indexNodeBuffer = nullptr;
 	}
 }
 
 
 /*
- * @brief clear hierarchical zbuffer data
+ * @brief clear hierarchical zbuffer data and select the raster kernels of the frame
+ * @detail the zbuffer is cleared tile by tile on the first write, see ClearTiles,
+ *         and the nodes by bumping the frame epoch, see getZ
  */
 void QuadTree::clear() {
-	const int resolution = _windowWidth * _windowHeight;
-	for (int i = 0; i < resolution; ++i) {
-		_zbuffer[i] = std::numeric_limits<float>::max();
-	}
+	_depthTiles.clear();
+	_acceptedCount = 0;
+	_selectRasterKernels();
 
-	if (_useHierarchical) {
-		for (auto node : _nodes) {
-			node.second.z = std::numeric_limits<float>::max();
+	if (++_frame == 0) {
+		for (auto& node : _nodes) {
+			node.second.epoch = 0;
 		}
+		_frame = 1;
 	}
 }
 
@@ -83,37 +98,37 @@ void QuadTree::_splitNode(QuadTreeNode* node) {
 			continue;
 		}
 
-		QuadTreeNode* nodeTemp = new QuadTreeNode((node->locCode << 2) | i);
+		QuadTreeNode child((node->locCode << 2) | i);
 		switch (i) {
 			case 0:
-				nodeTemp->box = new QuadBoundingBox{ 
+				child.box = new QuadBoundingBox{ 
 					box->xl, box->centerX, box->yl, box->centerY, 
 					(box->xl + box->centerX + 1) / 2, (box->yl + box->centerY + 1) / 2 
 				};
 				break;
 			case 1:
-				nodeTemp->box = new QuadBoundingBox{ 
+				child.box = new QuadBoundingBox{ 
 					box->centerX, box->xr, box->yl, box->centerY, 
 					(box->centerX + box->xr + 1) / 2, (box->yl + box->centerY + 1) / 2
 				};
 				break;
 			case 2:
-				nodeTemp->box = new QuadBoundingBox{ 
+				child.box = new QuadBoundingBox{ 
 					box->xl, box->centerX, box->centerY, box->yr, 
 					(box->xl + box->centerX + 1) / 2, (box->centerY + box->yr + 1) / 2
 				};
 				break;
 			case 3:
-				nodeTemp->box = new QuadBoundingBox{ 
+				child.box = new QuadBoundingBox{ 
 					box->centerX, box->xr, box->centerY, box->yr, 
 					(box->centerX + box->xr + 1) / 2, (box->centerY + box->yr + 1) / 2 
 				};
 				break;
 		}
 
-		nodeTemp->z = node->z;
+		child.z = node->z;
 		node->childExists |= (1 << i);
-		_nodes[nodeTemp->locCode] = *nodeTemp;
+		_nodes[child.locCode] = child;
 	}
 
 	// for all children
@@ -191,9 +206,10 @@ QuadTreeNode* QuadTree::searchNode(int screenX, int screenY, int screenRadius) {
  * @brief test a node that can the range of pixels
  */
 bool QuadTree::test(int* screenX, int* screenY, float z) {
+	PROFILE_ZONE_DETAIL("hzb test");
 	QuadTreeNode* node = _root;
 	while (true) {
-		if (node->z < z)
+		if (getZ(node) < z)
 			return false;
 		uint8_t quadCode[3] = { 0, 0, 0 };
 		for (int i = 0; i < 3; ++i) {
@@ -215,11 +231,67 @@ bool QuadTree::test(int* screenX, int* screenY, float z) {
 }
 
 
+/*
+ * @brief test if a rectangle of pixels at the nearest depth z may be visible
+ * @detail descends while both corners of the rectangle fall into the same child
+ */
+bool QuadTree::testRect(int xl, int yl, int xr, int yr, float z) {
+	PROFILE_ZONE_DETAIL("hzb rect test");
+	QuadTreeNode* node = _root;
+	while (true) {
+		if (getZ(node) < z) {
+			return false;
+		}
+
+		const uint8_t quadCodeMin = (yl < node->box->centerY ? 0 : 2) | (xl < node->box->centerX ? 0 : 1);
+		const uint8_t quadCodeMax = (yr < node->box->centerY ? 0 : 2) | (xr < node->box->centerX ? 0 : 1);
+		if (quadCodeMin == quadCodeMax && node->childExists & (1 << quadCodeMin)) {
+			node = &_nodes[(node->locCode << 2) | quadCodeMin];
+		}
+		else {
+			return true;
+		}
+	}
+}
+
+
 void QuadTree::activateHierachical(bool active) {
 	_useHierarchical = active;
 }
 
 
+void QuadTree::activateVisibilityBuffer(bool active) {
+	if (active != _useVisibilityBuffer) {
+		// the triangle ids are only cleared with the depth while the visibility buffer is active
+		_depthTiles.invalidate();
+		_useVisibilityBuffer = active;
+	}
+}
+
+
+/*
+ * @brief write no colors or triangle ids, e.g. for occluders or to find the visible nodes
+ */
+void QuadTree::activateDepthOnly(bool active) {
+	_useDepthOnly = active;
+}
+
+
+void QuadTree::setOverdrawCounters(OverdrawCounters* overdraw) {
+	_overdraw = overdraw;
+}
+
+
+const uint32_t* QuadTree::getTriangleIds() const {
+	return _triangleIds;
+}
+
+
+const ClearTiles& QuadTree::getDepthTiles() const {
+	return _depthTiles;
+}
+
+
 
 /*
  * @brief draw a triangle with scan line
@@ -232,32 +304,146 @@ bool QuadTree::handleTriangle(
 	const glm::vec3& objectColor,
 	const glm::vec3& lightColor,
 	const glm::vec3& lightDirection) {
+	const glm::mat3x3 normalMat = glm::mat3x3(glm::transpose(inverse(model)));
+	return handleTriangle(tri, projection * view * model, normalMat, objectColor, lightColor, lightDirection);
+}
+
+
+/*
+ * @brief draw a triangle with scan line
+ * @param mvp projection * view * model, computed once per object by the caller
+ * @param normalMatrix inverse transpose of the model matrix
+ * @return true if the triangle is culled or occluded
+ */
+bool QuadTree::handleTriangle(
+	const Triangle& tri,
+	const glm::mat4x4& mvp,
+	const glm::mat3x3& normalMatrix,
+	const glm::vec3& objectColor,
+	const glm::vec3& lightColor,
+	const glm::vec3& lightDirection) {
+	glm::vec4 clip[3];
+	float projectedX[3], projectedY[3];
 	int screenX[3], screenY[3];
 	float screenZ[3];
 	
-	float minZ = _processTriangle(tri, model, view, projection, screenX, screenY, screenZ);
+	float minZ;
+	{
+		PROFILE_ZONE_DETAIL("transform");
+		minZ = _processTriangle(tri, mvp, clip, projectedX, projectedY, screenZ);
+	}
+
+	{
+		PROFILE_ZONE_DETAIL("cull");
+		if (_culler && _culler->cull(clip, projectedX, projectedY) != Culler::CullResult::Visible) {
+			return true;
+		}
+	}
+
+	for (int i = 0; i < 3; ++i) {
+		screenX[i] = static_cast<int>(projectedX[i]);
+		screenY[i] = static_cast<int>(projectedY[i]);
+	}
 	
-	if (!_useHierarchical) {
-		const glm::mat3x3 normalMat = glm::mat3x3(glm::transpose(inverse(model)));
-		glm::vec3 ambient = 0.1f * lightColor;
-		glm::vec3 norm = glm::normalize(normalMat * tri.v[0].normal);
-		glm::vec3 diffuse = std::max(glm::dot(lightDirection, norm), 0.0f) * lightColor;
-		glm::vec3 color = (ambient + diffuse) * objectColor;
-		
-		_renderTriangle(screenX, screenY, screenZ, color);
-		return false;
-	} else if (test(screenX, screenY, minZ)) {
-		const glm::mat3x3 normalMat = glm::mat3x3(glm::transpose(inverse(model)));
-		glm::vec3 ambient = 0.1f * lightColor;
-		glm::vec3 norm = glm::normalize(normalMat * tri.v[0].normal);
-		glm::vec3 diffuse = std::max(glm::dot(lightDirection, norm), 0.0f) * lightColor;
-		glm::vec3 color = (ambient + diffuse) * objectColor;
-
-		_renderTriangle(screenX, screenY, screenZ, color);
-		return false;
+	QuadTreeNode* region = nullptr;
+	const int classification = _useHierarchical ?
+		_classifyTriangle(clip, screenX, screenY, screenZ, minZ, region) : 0;
+	if (classification < 0) {
+		return true;
+	}
+
+	glm::vec3 ambient = 0.1f * lightColor;
+	glm::vec3 norm = glm::normalize(normalMatrix * tri.v[0].normal);
+	glm::vec3 diffuse = std::max(glm::dot(lightDirection, norm), 0.0f) * lightColor;
+	uint32_t color = Framebuffer::packColor((ambient + diffuse) * objectColor);
+
+	PROFILE_ZONE_DETAIL("raster triangle");
+	if (classification > 0) {
+		_acceptTriangle(screenX, screenY, screenZ, color, region);
 	} else {
+		(this->*_rasterKernel)(screenX, screenY, screenZ, color);
+	}
+	return false;
+}
+
+
+/*
+ * @brief rasterize the depth and the id of a triangle without shading it
+ * @return true if the triangle is culled or occluded
+ */
+bool QuadTree::handleTriangle(const Triangle& tri, uint32_t triangleId, const glm::mat4x4& mvp) {
+	glm::vec4 clip[3];
+	float projectedX[3], projectedY[3];
+	int screenX[3], screenY[3];
+	float screenZ[3];
+
+	float minZ;
+	{
+		PROFILE_ZONE_DETAIL("transform");
+		minZ = _processTriangle(tri, mvp, clip, projectedX, projectedY, screenZ);
+	}
+
+	{
+		PROFILE_ZONE_DETAIL("cull");
+		if (_culler && _culler->cull(clip, projectedX, projectedY) != Culler::CullResult::Visible) {
+			return true;
+		}
+	}
+
+	for (int i = 0; i < 3; ++i) {
+		screenX[i] = static_cast<int>(projectedX[i]);
+		screenY[i] = static_cast<int>(projectedY[i]);
+	}
+
+	QuadTreeNode* region = nullptr;
+	const int classification = _useHierarchical ?
+		_classifyTriangle(clip, screenX, screenY, screenZ, minZ, region) : 0;
+	if (classification < 0) {
 		return true;
 	}
+
+	PROFILE_ZONE_DETAIL("raster triangle");
+	if (classification > 0) {
+		_acceptTriangle(screenX, screenY, screenZ, triangleId, region);
+	} else {
+		(this->*_rasterKernel)(screenX, screenY, screenZ, triangleId);
+	}
+	return false;
+}
+
+
+/*
+ * @brief draw the color of a rectangle of pixels in front of depth z,
+ *        without depth writes, e.g. a conservative splat
+ * @detail a splat stands for triangles which may cover only some of its
+ *         pixels, so it must not hide anything in the zbuffer or the hierarchy
+ * @param xl, yl, xr, yr inclusive pixel bounds on the screen
+ */
+void QuadTree::handleRect(int xl, int yl, int xr, int yr, float z, uint32_t value) {
+	if (_useVisibilityBuffer || _useDepthOnly) {
+		return;
+	}
+
+	PROFILE_ZONE_DETAIL("raster rect");
+	for (int y = yl; y <= yr; ++y) {
+		_depthTiles.touchSpan(y, xl, xr, [this](int xl, int yl, int xr, int yr) {
+			for (int y = yl; y < yr; ++y) {
+				std::fill(_zbuffer + y * _windowWidth + xl, _zbuffer + y * _windowWidth + xr,
+					std::numeric_limits<float>::max());
+			}
+		});
+		_framebuffer->touchSpan(y, xl, xr);
+
+		int index = _windowWidth * y + xl;
+		for (int x = xl; x <= xr; ++x, ++index) {
+			OVERDRAW_COUNT_TEST(_overdraw, index);
+			if (z < _zbuffer[index]) {
+				OVERDRAW_COUNT_PASS(_overdraw, index);
+				OVERDRAW_COUNT_WRITE(_overdraw, index);
+				_framebuffer->setPixel(x, y, value);
+			}
+		}
+	}
 }
 
 
@@ -268,13 +454,14 @@ void QuadTree::update(QuadTreeNode* node) {
 
 		for (int i = 0; i < 4; ++i) {
 			if (nodeParent->childExists & (1 << i)) {
-				uint32_t locCodeChild = nodeParent->locCode | i;
+				uint32_t locCodeChild = (nodeParent->locCode << 2) | i;
 				QuadTreeNode* nodeChild = _getNode(locCodeChild);
-				maxZ = std::max(maxZ, nodeChild->z);
+				maxZ = std::max(maxZ, getZ(nodeChild));
 			}
 		}
 
-		if (maxZ < nodeParent->z) {
+		if (maxZ < getZ(nodeParent)) {
+			_touchNode(nodeParent);
 			nodeParent->z = maxZ;
 			update(nodeParent);
 		}
@@ -294,18 +481,21 @@ size_t QuadTree::getDepth(const QuadTreeNode* node) const {
 }
 
 
+/*
+ * @brief transform a triangle to clip space and project it to the screen
+ * @return the nearest depth of the triangle
+ */
 float QuadTree::_processTriangle(
 	const Triangle& tri,
-	const glm::mat4x4& model,
-	const glm::mat4x4& view,
-	const glm::mat4x4& projection,
-	int* screenX, int* screenY, float* screenZ) {
+	const glm::mat4x4& mvp,
+	glm::vec4* clip, float* screenX, float* screenY, float* screenZ) {
 	float minZ = FLT_MAX;
 	for (int i = 0; i < 3; ++i) {
-		glm::vec4 v = projection * view * model * glm::vec4(tri.v[i].position, 1.0f);
+		clip[i] = mvp * glm::vec4(tri.v[i].position, 1.0f);
+		const glm::vec4& v = clip[i];
 
-		screenX[i] = int((v.x / v.w + 1.0f) * _windowWidth / 2);
-		screenY[i] = int((v.y / v.w + 1.0f) * _windowHeight / 2);
+		screenX[i] = (v.x / v.w + 1.0f) * _windowWidth / 2;
+		screenY[i] = (v.y / v.w + 1.0f) * _windowHeight / 2;
 		screenZ[i] = v.z / v.w;
 
 		minZ = std::min(minZ, screenZ[i]);
@@ -315,7 +505,8 @@ float QuadTree::_processTriangle(
 }
 
 
-void QuadTree::_renderTriangle(int* screenX, int* screenY, float* screenZ, const glm::vec3& color) {
+template <uint32_t features>
+void QuadTree::_renderTriangle(int* screenX, int* screenY, float* screenZ, uint32_t value) {
 	// sort the edge of the triangle
 	Side sides[3];
 	for (int i = 0; i < 3; ++i) {
@@ -353,13 +544,13 @@ void QuadTree::_renderTriangle(int* screenX, int* screenY, float* screenZ, const
 		int left = flag ? index1 : index2;
 		int right = flag ? index2 : index1;
 		int dy = sides[left].dy;
-		_scanTwoLine(sides, left, right, dy, color);
+		_scanTwoLine<features>(sides, left, right, dy, value);
 	} else {
 		bool flag = sides[0].dx < sides[1].dx ? true : false;
 		int left = flag ? 0 : 1;
 		int right = flag ? 1 : 0;
 		int dy = std::min(sides[left].dy, sides[right].dy);
-		_scanTwoLine(sides, left, right, dy, color);
+		_scanTwoLine<features>(sides, left, right, dy, value);
 		int index;
 		if (sides[left].dy < sides[right].dy)
 			left = 2, index = right;
@@ -373,12 +564,13 @@ void QuadTree::_renderTriangle(int* screenX, int* screenY, float* screenZ, const
 		sides[index].z += dy * sides[index].dz;
 		sides[index].dy -= dy;
 		dy = sides[index].dy;
-		_scanTwoLine(sides, left, right, dy, color);
+		_scanTwoLine<features>(sides, left, right, dy, value);
 	}
 }
 
 
-void QuadTree::_scanTwoLine(Side* sides, int left, int right, int dy, const glm::vec3& color) {
+template <uint32_t features>
+void QuadTree::_scanTwoLine(Side* sides, int left, int right, int dy, uint32_t value) {
 	ScanLine scanLine;
 	float xl = sides[left].x;
 	float xr = sides[right].x;
@@ -391,7 +583,7 @@ void QuadTree::_scanTwoLine(Side* sides, int left, int right, int dy, const glm:
 		scanLine.dz = (sides[right].z + i * sides[right].dz - scanLine.zl) / (scanLine.xr - scanLine.xl);
 
 		if (scanLine.y >= 0 && scanLine.y < _windowHeight) {
-			_fillLine(scanLine, color);
+			_fillLine<features>(scanLine, value);
 		}
 
 		xl += sides[left].dx;
@@ -402,20 +594,58 @@ void QuadTree::_scanTwoLine(Side* sides, int left, int right, int dy, const glm:
 }
 
 
-void QuadTree::_fillLine(ScanLine scanline, const glm::vec3& color) {
+template <uint32_t features>
+void QuadTree::_fillLine(ScanLine scanline, uint32_t value) {
 	int y = scanline.y;
 	float z = scanline.zl;
 	int index = _windowWidth * y + scanline.xl;
 
+	const int xMin = std::max(scanline.xl, 0);
+	const int xMax = std::min(scanline.xr, _windowWidth - 1);
+	if (xMin > xMax) {
+		return;
+	}
+
+	_depthTiles.touchSpan(y, xMin, xMax, [this](int xl, int yl, int xr, int yr) {
+		for (int y = yl; y < yr; ++y) {
+			std::fill(_zbuffer + y * _windowWidth + xl, _zbuffer + y * _windowWidth + xr,
+				std::numeric_limits<float>::max());
+			if constexpr ((features & VisibilityBuffer) != 0) {
+				std::fill(_triangleIds + y * _windowWidth + xl, _triangleIds + y * _windowWidth + xr,
+					invalidTriangleId);
+			}
+		}
+	});
+
+	if constexpr ((features & (VisibilityBuffer | DepthOnly)) == 0) {
+		_framebuffer->touchSpan(y, xMin, xMax);
+	}
+
+	if constexpr ((features & Accepting) != 0) {
+		_acceptedSpans[y].first = std::min(_acceptedSpans[y].first, xMin);
+		_acceptedSpans[y].second = std::max(_acceptedSpans[y].second, xMax);
+	}
+
 	for (int x = scanline.xl; x <= scanline.xr; ++x) {
-		if (x >= 0 && x < _windowWidth && z < _zbuffer[index] && z >= -1.0f) {
-			_zbuffer[index] = z;
-			_framebuffer->setPixel(x, y, color);
-
-			QuadTreeNode* node = &_nodes[_indexNodeBuffer[index]];
-			node->z = z;
-			if (_useHierarchical == true) {
-				update(node);
+		if (x >= 0 && x < _windowWidth) {
+			if constexpr ((features & (Accepting | Counting)) == Counting) {
+				OVERDRAW_COUNT_TEST(_overdraw, index);
+			}
+
+			if ((features & Accepting) != 0 || (z < _zbuffer[index] && z >= -1.0f)) {
+				if constexpr ((features & Counting) != 0) {
+					OVERDRAW_COUNT_PASS(_overdraw, index);
+				}
+
+				if constexpr ((features & (VisibilityBuffer | DepthOnly)) == VisibilityBuffer) {
+					_triangleIds[index] = value;
+				} else if constexpr ((features & DepthOnly) == 0) {
+					if constexpr ((features & Counting) != 0) {
+						OVERDRAW_COUNT_WRITE(_overdraw, index);
+					}
+					_framebuffer->setPixel(x, y, value);
+				}
+				_writeDepth<features>(index, z);
 			}
 		}
 		z += scanline.dz;
@@ -435,6 +665,242 @@ QuadTreeNode* QuadTree::_getNode(uint32_t locCode) {
 }
 
 
+/*
+ * @brief make a node of an older frame a cleared node of this frame
+ */
+void QuadTree::_touchNode(QuadTreeNode* node) {
+	if (node->epoch != _frame) {
+		node->z = std::numeric_limits<float>::max();
+		node->minZ = std::numeric_limits<float>::max();
+		node->epoch = _frame;
+	}
+}
+
+
+/*
+ * @brief test a triangle against the farthest and the nearest z of its region
+ * @detail descends as test does. A triangle whose farthest z is nearer than
+ *         the nearest z of its region passes the depth test at every pixel.
+ * @param region set to the smallest node containing the triangle
+ * @return -1 if it is behind the zbuffer, 1 if it is in front of its region, 0 otherwise
+ */
+int QuadTree::_classifyTriangle(const glm::vec4* clip, int* screenX, int* screenY, const float* screenZ,
+	float minZ, QuadTreeNode*& region) {
+	PROFILE_ZONE_DETAIL("hzb test");
+	// the projected z of a vertex behind the near plane or the eye bounds nothing
+	float maxZ = std::numeric_limits<float>::max();
+	if (minZ >= -1.0f && clip[0].w > 0.0f && clip[1].w > 0.0f && clip[2].w > 0.0f) {
+		maxZ = std::max(screenZ[0], std::max(screenZ[1], screenZ[2]));
+	}
+
+	QuadTreeNode* node = _root;
+	while (true) {
+		if (getZ(node) < minZ) {
+			return -1;
+		}
+
+		uint8_t quadCode[3] = { 0, 0, 0 };
+		for (int i = 0; i < 3; ++i) {
+			quadCode[i] |= screenY[i] < node->box->centerY ? 0 : 1;
+			quadCode[i] <<= 1;
+			quadCode[i] |= screenX[i] < node->box->centerX ? 0 : 1;
+		}
+
+		if (quadCode[0] == quadCode[1] &&
+			quadCode[1] == quadCode[2] &&
+			node->childExists & (1 << quadCode[0])) {
+			node = &_nodes[(node->locCode << 2) | quadCode[0]];
+		} else {
+			break;
+		}
+	}
+
+	region = node;
+	return maxZ < getMinZ(node) ? 1 : 0;
+}
+
+
+/*
+ * @brief rasterize a triangle in front of its region without depth tests
+ * @detail the written columns of every row are kept, so the hierarchy is
+ *         updated once per node afterwards instead of once per pixel
+ */
+void QuadTree::_acceptTriangle(int* screenX, int* screenY, float* screenZ, uint32_t value, QuadTreeNode* region) {
+	++_acceptedCount;
+	_acceptedYl = std::clamp(std::min(screenY[0], std::min(screenY[1], screenY[2])), 0, _windowHeight);
+	_acceptedYr = std::clamp(std::max(screenY[0], std::max(screenY[1], screenY[2])) + 1, 0, _windowHeight);
+	for (int y = _acceptedYl; y < _acceptedYr; ++y) {
+		_acceptedSpans[y] = std::make_pair(_windowWidth, -1);
+	}
+	_acceptedMaxZ = std::numeric_limits<float>::lowest();
+
+	(this->*_acceptKernel)(screenX, screenY, screenZ, value);
+
+	// no pixel written
+	if (_acceptedMaxZ == std::numeric_limits<float>::lowest()) {
+		return;
+	}
+
+	PROFILE_ZONE_DETAIL("hzb update");
+	_refitAccepted(region);
+	update(region);
+}
+
+
+/*
+ * @brief select the kernels of the active features
+ */
+void QuadTree::_selectRasterKernels() {
+	uint32_t features = 0;
+	if (_useHierarchical) {
+		features |= Hierarchical;
+	}
+	if (_useVisibilityBuffer) {
+		features |= VisibilityBuffer;
+	}
+	if (_useDepthOnly) {
+		features |= DepthOnly;
+	}
+#ifdef ENABLE_OVERDRAW_STATISTICS
+	if (_overdraw != nullptr) {
+		features |= Counting;
+	}
+#endif
+
+	_rasterKernel = _rasterKernels[features];
+	_acceptKernel = _rasterKernels[features | Accepting];
+}
+
+
+/*
+ * @brief write the depth of a pixel and update the hierarchy
+ * @detail the farthest z of an accepted triangle is updated once per node
+ *         afterwards, see _refitAccepted
+ */
+template <uint32_t features>
+void QuadTree::_writeDepth(int index, float z) {
+	_zbuffer[index] = z;
+	QuadTreeNode* node = &_nodes[_indexNodeBuffer[index]];
+	_touchNode(node);
+	node->z = z;
+	node->minZ = z;
+
+	if constexpr ((features & Hierarchical) != 0) {
+		PROFILE_ZONE_DETAIL("hzb update");
+		if constexpr ((features & Accepting) != 0) {
+			_acceptedMaxZ = std::max(_acceptedMaxZ, z);
+		}
+		_updateAncestors(node, z, (features & Accepting) == 0);
+	}
+}
+
+
+/*
+ * @brief update the nearest and the farthest z of the ancestors of a written pixel
+ * @detail the nearest z of an ancestor only decreases to z, the farthest z is
+ *         taken from the children as in update. Each stops at the first
+ *         ancestor keeping its value, the parent of a level is looked up once
+ *         for both.
+ */
+void QuadTree::_updateAncestors(QuadTreeNode* node, float z, bool farthest) {
+	while (node->locCode > 1) {
+		QuadTreeNode* nodeParent = _getParent(node);
+		bool changed = false;
+		if (z < getMinZ(nodeParent)) {
+			_touchNode(nodeParent);
+			nodeParent->minZ = z;
+			changed = true;
+		}
+
+		if (farthest) {
+			float maxZ = -1.0f;
+			for (int i = 0; i < 4; ++i) {
+				if (nodeParent->childExists & (1 << i)) {
+					maxZ = std::max(maxZ, getZ(_getNode((nodeParent->locCode << 2) | i)));
+				}
+			}
+
+			if (maxZ < getZ(nodeParent)) {
+				_touchNode(nodeParent);
+				nodeParent->z = maxZ;
+				changed = true;
+			} else {
+				farthest = false;
+			}
+		}
+
+		if (!changed) {
+			break;
+		}
+		node = nodeParent;
+	}
+}
+
+
+/*
+ * @brief update the farthest z of the subtree of a region after an accepted triangle
+ * @detail a node the triangle covers completely takes the farthest written
+ *         z, its descendants keep their older values, which are farther, so
+ *         they only reject less. The nodes on the edges of the triangle are
+ *         updated from their children.
+ * @return farthest z of the node
+ */
+float QuadTree::_refitAccepted(QuadTreeNode* node) {
+	const QuadBoundingBox* box = node->box;
+	const int yl = std::max(box->yl, _acceptedYl);
+	const int yr = std::min(box->yr, _acceptedYr);
+
+	bool covered = yl == box->yl && yr == box->yr;
+	bool touched = false;
+	for (int y = yl; y < yr; ++y) {
+		const std::pair<int, int>& span = _acceptedSpans[y];
+		if (span.first <= box->xl && span.second >= box->xr - 1) {
+			touched = true;
+		} else {
+			covered = false;
+			touched = touched || (span.first < box->xr && span.second >= box->xl);
+		}
+	}
+
+	if (!touched) {
+		return getZ(node);
+	}
+
+	_touchNode(node);
+	if (covered || node->childExists == 0) {
+		node->z = std::min(node->z, _acceptedMaxZ);
+		return node->z;
+	}
+
+	float maxZ = -1.0f;
+	for (int i = 0; i < 4; ++i) {
+		if (node->childExists & (1 << i)) {
+			maxZ = std::max(maxZ, _refitAccepted(_getNode((node->locCode << 2) | i)));
+		}
+	}
+
+	node->z = std::min(node->z, maxZ);
+	return node->z;
+}
+
+
+uint32_t QuadTree::getAcceptedCount() const {
+	return _acceptedCount;
+}
+
+
+const QuadTree::RasterKernel QuadTree::_rasterKernels[QuadTree::rasterKernelCount] = {
+	&QuadTree::_renderTriangle<0>,  &QuadTree::_renderTriangle<1>,  &QuadTree::_renderTriangle<2>,  &QuadTree::_renderTriangle<3>,
+	&QuadTree::_renderTriangle<4>,  &QuadTree::_renderTriangle<5>,  &QuadTree::_renderTriangle<6>,  &QuadTree::_renderTriangle<7>,
+	&QuadTree::_renderTriangle<8>,  &QuadTree::_renderTriangle<9>,  &QuadTree::_renderTriangle<10>, &QuadTree::_renderTriangle<11>,
+	&QuadTree::_renderTriangle<12>, &QuadTree::_renderTriangle<13>, &QuadTree::_renderTriangle<14>, &QuadTree::_renderTriangle<15>,
+	&QuadTree::_renderTriangle<16>, &QuadTree::_renderTriangle<17>, &QuadTree::_renderTriangle<18>, &QuadTree::_renderTriangle<19>,
+	&QuadTree::_renderTriangle<20>, &QuadTree::_renderTriangle<21>, &QuadTree::_renderTriangle<22>, &QuadTree::_renderTriangle<23>,
+	&QuadTree::_renderTriangle<24>, &QuadTree::_renderTriangle<25>, &QuadTree::_renderTriangle<26>, &QuadTree::_renderTriangle<27>,
+	&QuadTree::_renderTriangle<28>, &QuadTree::_renderTriangle<29>, &QuadTree::_renderTriangle<30>, &QuadTree::_renderTriangle<31>,
+};
+
+
 void testAndSet(int x, int y, float z) {
 	
 }
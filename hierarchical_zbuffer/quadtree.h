@@ -2,10 +2,16 @@
 #include "mesh.h"
 #include "octree.h"
 #include "framebuffer.h"
+#include "culler.h"
+#include "clear_tiles.h"
+#include "overdraw.h"
 #include <climits>
 #include <algorithm>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 #include <glm/mat4x4.hpp>
+#include "core/memory_tracker.h"
 
 
 struct QuadBoundingBox {
@@ -18,6 +24,10 @@ struct QuadBoundingBox {
 struct QuadTreeNode {
 	QuadBoundingBox* box = nullptr;
 	float z = 1.0f;
+	/* nearest z of the region, see QuadTree::getMinZ */
+	float minZ = std::numeric_limits<float>::max();
+	/* frame in which z was written, z of an older frame is cleared */
+	uint32_t epoch = 0;
 	uint32_t locCode = std::numeric_limits<uint32_t>::max();
 	uint8_t childExists = 0;
 
@@ -28,10 +38,33 @@ struct QuadTreeNode {
 
 class QuadTree {
 public:
+	/* triangle id of the pixels no triangle covers */
+	static constexpr uint32_t invalidTriangleId = std::numeric_limits<uint32_t>::max();
+
+	/*
+	 * @brief compile time features of a raster kernel
+	 * @detail every combination is instantiated, clear selects the kernels of
+	 *         the frame so the inner loops do not branch on the mode
+	 */
+	enum RasterFeature : uint32_t {
+		/* update the hierarchy on depth writes */
+		Hierarchical = 1 << 0,
+		/* write triangle ids instead of colors */
+		VisibilityBuffer = 1 << 1,
+		/* the triangle is in front of its region, no depth tests */
+		Accepting = 1 << 2,
+		/* count the depth tests and writes, see ENABLE_OVERDRAW_STATISTICS */
+		Counting = 1 << 3,
+		/* write the depth and the hierarchy only, no colors or triangle ids */
+		DepthOnly = 1 << 4,
+	};
+
+	static constexpr uint32_t rasterKernelCount = 32;
+
 	/*
 	 * @brief constructor
 	 */
-	QuadTree(int Width, int Height, Framebuffer* framebuffer);
+	QuadTree(int Width, int Height, Framebuffer* framebuffer, Culler* culler = nullptr);
 
 	/*
 	 * @brief destructor
@@ -48,6 +81,13 @@ public:
 	 */
 	bool test(int* screenX, int* screenY, float z);
 
+	/*
+	 * @brief test if a rectangle of pixels at the nearest depth z may be visible
+	 * @param xl, yl, xr, yr inclusive pixel bounds of the rectangle
+	 * @return false if the rectangle is behind the zbuffer
+	 */
+	bool testRect(int xl, int yl, int xr, int yr, float z);
+
 	/*
 	 * @brief search a node that can the range of pixels
 	 */
@@ -55,6 +95,7 @@ public:
 	
 	/*
 	 * @brief draw a triangle with scan line
+	 * @return true if the triangle is culled or occluded
 	 */
 	bool handleTriangle(const Triangle& tri, 
 		const glm::mat4x4& model, 
@@ -64,13 +105,41 @@ public:
 		const glm::vec3& lightColor,
 		const glm::vec3& lightDirection);
 	
+	/*
+	 * @brief draw a triangle with scan line
+	 * @param mvp projection * view * model, computed once per object by the caller
+	 * @param normalMatrix inverse transpose of the model matrix
+	 * @return true if the triangle is culled or occluded
+	 */
+	bool handleTriangle(const Triangle& tri,
+		const glm::mat4x4& mvp,
+		const glm::mat3x3& normalMatrix,
+		const glm::vec3& ambientColor,
+		const glm::vec3& lightColor,
+		const glm::vec3& lightDirection);
+
+	/*
+	 * @brief rasterize the depth and the id of a triangle without shading it
+	 * @note only valid while the visibility buffer is active
+	 * @return true if the triangle is culled or occluded
+	 */
+	bool handleTriangle(const Triangle& tri, uint32_t triangleId, const glm::mat4x4& mvp);
+
+	/*
+	 * @brief draw the color of a rectangle of pixels in front of depth z,
+	 *        without depth writes, e.g. a conservative splat
+	 * @param xl, yl, xr, yr inclusive pixel bounds on the screen
+	 * @note draws nothing while the visibility buffer or depth only is active
+	 */
+	void handleRect(int xl, int yl, int xr, int yr, float z, uint32_t value);
+
 	/*
 	 * @brief update zbuffer
 	 */
 	void update(QuadTreeNode* node);
 	
 	/*
-     * @brief clear hierarchical zbuffer data
+     * @brief clear hierarchical zbuffer data and select the raster kernels of the frame
 	 */
 	void clear();
 	
@@ -80,23 +149,108 @@ public:
 	 */
 	size_t getDepth(const QuadTreeNode* node) const;
 
+	/*
+	 * @brief get the farthest z value of the region of a node in this frame
+	 */
+	float getZ(const QuadTreeNode* node) const {
+		return node->epoch == _frame ? node->z : std::numeric_limits<float>::max();
+	}
+
+	/*
+	 * @brief get the nearest z value of the region of a node in this frame
+	 */
+	float getMinZ(const QuadTreeNode* node) const {
+		return node->epoch == _frame ? node->minZ : std::numeric_limits<float>::max();
+	}
+
+	/*
+	 * @brief get the farthest z of the screen
+	 * @detail finite once every pixel is written, nothing at or behind it is visible
+	 */
+	float getCoveredDepth() const {
+		return getZ(_root);
+	}
+
+	/*
+	 * @brief get the triangles written without depth tests since the last clear
+	 */
+	uint32_t getAcceptedCount() const;
+
 	void activateHierachical(bool active);
 
+	/*
+	 * @brief write triangle ids instead of colors, see getTriangleIds
+	 */
+	void activateVisibilityBuffer(bool active);
+
+	/*
+	 * @brief write no colors or triangle ids, e.g. for occluders or to find the visible nodes
+	 */
+	void activateDepthOnly(bool active);
+
+	/*
+	 * @brief count the depth tests and writes, see ENABLE_OVERDRAW_STATISTICS
+	 */
+	void setOverdrawCounters(OverdrawCounters* overdraw);
+
+	/*
+	 * @brief get the id of the nearest triangle per pixel
+	 * @note a pixel is only valid if its tile is touched in getDepthTiles
+	 */
+	const uint32_t* getTriangleIds() const;
+
+	/*
+	 * @brief get the lazily cleared tiles of the zbuffer and the triangle ids
+	 */
+	const ClearTiles& getDepthTiles() const;
+
 private:
 	QuadTreeNode* _root = nullptr;
 	
 	float* _zbuffer = nullptr;
+
+	/* triangle id per pixel, written instead of the color by the visibility buffer */
+	uint32_t* _triangleIds = nullptr;
+
+	/* lazily cleared tiles of the zbuffer and the triangle ids */
+	ClearTiles _depthTiles;
+
+	/* current frame, the nodes with a different epoch are cleared */
+	uint32_t _frame = 1;
 	
 	uint32_t* _indexNodeBuffer = nullptr;
 	
 	int _windowWidth = 0, _windowHeight = 0;
 
-	std::unordered_map<uint32_t, QuadTreeNode> _nodes;
+	std::unordered_map<uint32_t, QuadTreeNode, std::hash<uint32_t>, std::equal_to<uint32_t>,
+		TrackingAllocator<std::pair<const uint32_t, QuadTreeNode>, MemoryTag::QuadTree>> _nodes;
+
+	/* the node index buffer and the bounding boxes, the nodes are tracked by their map */
+	MemoryRegistration _memory{ MemoryTag::QuadTree };
+
+	/* the zbuffer and the triangle ids */
+	MemoryRegistration _depthMemory{ MemoryTag::Depth };
 	
 	Framebuffer* _framebuffer = nullptr;
 
+	Culler* _culler = nullptr;
+
+	OverdrawCounters* _overdraw = nullptr;
+
 	bool _useHierarchical = true;
 
+	bool _useVisibilityBuffer = false;
+
+	bool _useDepthOnly = false;
+
+	/* triangles written without depth tests since the last clear */
+	uint32_t _acceptedCount = 0;
+
+	/* farthest written z and written columns per row of the accepted triangle */
+	float _acceptedMaxZ = 0.0f;
+	int _acceptedYl = 0, _acceptedYr = 0;
+	std::vector<std::pair<int, int>> _acceptedSpans;
+
 	struct Side {
 		int yMin;
 		int x;
@@ -113,6 +267,18 @@ private:
 		float dz;
 	};
 
+	/*
+	 * @brief rasterize a triangle, value is the color or the triangle id
+	 */
+	using RasterKernel = void (QuadTree::*)(int* screenX, int* screenY, float* screenZ, uint32_t value);
+
+	/* _renderTriangle instantiated for every combination of RasterFeature */
+	static const RasterKernel _rasterKernels[rasterKernelCount];
+
+	/* kernels of the frame for the triangles tested per pixel and the accepted ones */
+	RasterKernel _rasterKernel = nullptr;
+	RasterKernel _acceptKernel = nullptr;
+
 	/*
 	 * @brief clear hierarchical zbuffer data
 	 */
@@ -125,14 +291,60 @@ private:
 
 	QuadTreeNode* _getNode(uint32_t locCode);
 
-	float _processTriangle(const Triangle& tri,
-		const glm::mat4x4& model, const glm::mat4x4& view, const glm::mat4x4& projection,
-		int* screenX, int* screenY, float* screenZ);
+	/*
+	 * @brief make a node of an older frame a cleared node of this frame
+	 */
+	void _touchNode(QuadTreeNode* node);
+
+	/*
+	 * @brief test a triangle against the farthest and the nearest z of its region
+	 * @param region set to the smallest node containing the triangle
+	 * @return -1 if it is behind the zbuffer, 1 if it is in front of its region, 0 otherwise
+	 */
+	int _classifyTriangle(const glm::vec4* clip, int* screenX, int* screenY, const float* screenZ,
+		float minZ, QuadTreeNode*& region);
+
+	/*
+	 * @brief rasterize a triangle in front of its region without depth tests
+	 */
+	void _acceptTriangle(int* screenX, int* screenY, float* screenZ, uint32_t value, QuadTreeNode* region);
+
+	/*
+	 * @brief select the kernels of the active features
+	 */
+	void _selectRasterKernels();
+
+	/*
+	 * @brief write the depth of a pixel and update the hierarchy
+	 */
+	template <uint32_t features>
+	void _writeDepth(int index, float z);
 
+	/*
+	 * @brief update the nearest and the farthest z of the ancestors of a written pixel
+	 * @param farthest false to update the nearest z only
+	 */
+	void _updateAncestors(QuadTreeNode* node, float z, bool farthest);
 
-	void _renderTriangle(int* screenX, int* screenY, float* screenZ, const glm::vec3& color);
+	/*
+	 * @brief update the subtree of a region after an accepted triangle
+	 * @return farthest z of the node
+	 */
+	float _refitAccepted(QuadTreeNode* node);
+
+	float _processTriangle(const Triangle& tri, const glm::mat4x4& mvp,
+		glm::vec4* clip, float* screenX, float* screenY, float* screenZ);
+
+
+	/*
+	 * @brief rasterize a triangle, value is the color or the triangle id
+	 */
+	template <uint32_t features>
+	void _renderTriangle(int* screenX, int* screenY, float* screenZ, uint32_t value);
 
-	void _scanTwoLine(Side* sides, int left, int right, int dy, const glm::vec3& color);
+	template <uint32_t features>
+	void _scanTwoLine(Side* sides, int left, int right, int dy, uint32_t value);
 
-	void _fillLine(ScanLine scanLine, const glm::vec3& color);
+	template <uint32_t features>
+	void _fillLine(ScanLine scanLine, uint32_t value);
 };
\ No newline at end of file
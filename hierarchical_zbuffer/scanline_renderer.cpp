@@ -1,4 +1,9 @@
 #include <iostream>
+#include <stdexcept>
+#include "core/job_system.h"
+#include "allocation_counter.h"
+#include "depth_sort.h"
+#include "core/profiler.h"
 #include "scanline_renderer.h"
 #include <cstdio>
 
@@ -11,12 +16,44 @@ ScanlineRenderer::ScanlineRenderer(
 	: _framebuffer(framebuffer),
 	_windowWidth(windowWidth), _windowHeight(windowHeight),
 	_clearColor(clearColor),
-	_triangles(triangles) {
-	_classifiedPolygonTable.resize(windowHeight);
-	_classifiedEdgeTable.resize(windowHeight);
+	_triangles(triangles), _frameTriangles(&triangles) {
+	_clearRenderData();
 	_zbuffer = new Zbuffer(windowWidth, windowHeight);
-	_quadTree = new QuadTree(windowWidth, windowHeight, &_framebuffer);
+	_quadTree = new QuadTree(windowWidth, windowHeight, &_framebuffer, &_culler);
+#ifdef ENABLE_OVERDRAW_STATISTICS
+	_overdraw.resize(windowWidth, windowHeight);
+	_quadTree->setOverdrawCounters(&_overdraw);
+#endif
 	_octree = new Octree(&triangles, 20);
+	_clusters = new ClusterSet(triangles);
+}
+
+
+ScanlineRenderer::~ScanlineRenderer() {
+	if (_sceneTree != nullptr) {
+		delete _sceneTree;
+		_sceneTree = nullptr;
+	}
+
+	if (_clusters != nullptr) {
+		delete _clusters;
+		_clusters = nullptr;
+	}
+
+	if (_octree != nullptr) {
+		delete _octree;
+		_octree = nullptr;
+	}
+
+	if (_quadTree != nullptr) {
+		delete _quadTree;
+		_quadTree = nullptr;
+	}
+
+	if (_zbuffer != nullptr) {
+		delete _zbuffer;
+		_zbuffer = nullptr;
+	}
 }
 
 
@@ -27,15 +64,45 @@ void ScanlineRenderer::render(
 	const glm::vec3& objectColor,
 	const glm::vec3& lightColor,
 	const glm::vec3& lightDirection) {
+	PROFILE_ZONE("frame");
+	PerfStages::Scope perfFrame(_perfStages, "frame");
+	const uint64_t allocationCount = AllocationCounter::getCount();
+
+	// the scan line tables live in the frame arena, so they are cleared with it
+	_clearRenderData();
+
 	framebuffer.clear(_clearColor);
+	_culler.resetStatistics();
+	_occludedCount = 0;
+	_clusterStatistics = ClusterSet::Statistics();
+	_octreeStatistics = Octree::Statistics();
+	_instanceStatistics = Instance::Statistics();
+	_frameTriangles = &_triangles;
+#ifdef ENABLE_OVERDRAW_STATISTICS
+	_overdraw.clear();
+#endif
 
 	if (_renderMode == RenderMode::Global) {
 		_zbuffer->clear();
-		_clearRenderData();
-		_assembleRenderData(camera, models, objectColor, lightColor, lightDirection);
-		_scan(framebuffer);
+		{
+			PROFILE_ZONE("transform and cull");
+			PerfStages::Scope perfStage(_perfStages, "transform and cull");
+			_assembleRenderData(camera, models, objectColor, lightColor, lightDirection);
+		}
+		{
+			PROFILE_ZONE("raster");
+			PerfStages::Scope perfStage(_perfStages, "raster");
+			_scan(framebuffer);
+		}
 	}
 	else {
+		_quadTree->activateVisibilityBuffer(_renderMode == RenderMode::VisibilityBuffer);
+		if (_renderMode == RenderMode::ZBuffer ||
+			_renderMode == RenderMode::HierarchicalZBuffer ||
+			_renderMode == RenderMode::VisibilityBuffer) {
+			_frameTriangles = _selectLods(camera);
+		}
+
 		if (_renderMode == RenderMode::ZBuffer) {
 			_quadTree->activateHierachical(false);
 			_quadTree->clear();
@@ -46,6 +113,24 @@ void ScanlineRenderer::render(
 			_quadTree->clear();
 			_renderWithHierarchicalZBuffer(camera, objectColor, lightColor, lightDirection);
 		}
+		else if (_renderMode == RenderMode::VisibilityBuffer) {
+			_quadTree->activateHierachical(true);
+			_quadTree->clear();
+			_renderWithVisibilityBuffer(camera);
+
+			PerfStages::Scope perfStage(_perfStages, "resolve");
+			_resolveVisibilityBuffer(framebuffer, objectColor, lightColor, lightDirection);
+		}
+		else if (_renderMode == RenderMode::Cluster) {
+			_quadTree->activateHierachical(true);
+			_quadTree->clear();
+			_renderWithClusters(camera, objectColor, lightColor, lightDirection);
+		}
+		else if (_renderMode == RenderMode::Instanced) {
+			_quadTree->activateHierachical(true);
+			_quadTree->clear();
+			_renderWithInstances(camera, objectColor, lightColor, lightDirection);
+		}
 		else {
 			_quadTree->activateHierachical(true);
 			_quadTree->clear();
@@ -53,7 +138,11 @@ void ScanlineRenderer::render(
 		}
 	}
 
+	PROFILE_ZONE("present");
+	PerfStages::Scope perfPresent(_perfStages, "present");
 	framebuffer.render();
+
+	_frameAllocationCount = AllocationCounter::getCount() - allocationCount;
 }
 
 
@@ -62,25 +151,208 @@ enum ScanlineRenderer::RenderMode ScanlineRenderer::getRenderMode() const {
 }
 
 
+const char* ScanlineRenderer::getRenderModeName(enum RenderMode renderMode) {
+	switch (renderMode) {
+	case RenderMode::Global:
+		return "global";
+	case RenderMode::ZBuffer:
+		return "zbuffer";
+	case RenderMode::HierarchicalZBuffer:
+		return "hzb";
+	case RenderMode::OctreeHierarchicalZBuffer:
+		return "octree";
+	case RenderMode::VisibilityBuffer:
+		return "visibility";
+	case RenderMode::Cluster:
+		return "cluster";
+	case RenderMode::Instanced:
+		return "instanced";
+	}
+
+	return "unknown";
+}
+
+
 void ScanlineRenderer::setRenderMode(enum RenderMode renderMode) {
 	_renderMode = renderMode;
 }
 
 
+Culler& ScanlineRenderer::getCuller() {
+	return _culler;
+}
+
+
+const Culler::Statistics& ScanlineRenderer::getCullStatistics() const {
+	return _culler.getStatistics();
+}
+
+
+const ClusterSet::Statistics& ScanlineRenderer::getClusterStatistics() const {
+	return _clusterStatistics;
+}
+
+
+void ScanlineRenderer::setInstances(const std::vector<Instance>* instances) {
+	_instances = instances;
+
+	if (_sceneTree != nullptr) {
+		delete _sceneTree;
+		_sceneTree = nullptr;
+	}
+
+	if (_instances != nullptr) {
+		_sceneTree = new SceneTree(_instances);
+	}
+}
+
+
+SceneTree* ScanlineRenderer::getSceneTree() {
+	return _sceneTree;
+}
+
+
+void ScanlineRenderer::setPotentiallyVisibleSet(const PotentiallyVisibleSet* visibleSet) {
+	if (visibleSet != nullptr && visibleSet->getNodeCount() != _octree->getNodeCount()) {
+		throw std::invalid_argument("the potentially visible set was built for another octree");
+	}
+
+	_visibleSet = visibleSet;
+	_visibleSetCell = -1;
+}
+
+
+void ScanlineRenderer::setVisibleNodeRecord(std::vector<bool>* visibleNodes) {
+	_visibleNodeRecord = visibleNodes;
+	if (_visibleNodeRecord != nullptr) {
+		_visibleNodeRecord->assign(_octree->getNodeCount(), false);
+	}
+}
+
+
+const Octree::Statistics& ScanlineRenderer::getOctreeStatistics() const {
+	return _octreeStatistics;
+}
+
+
+const Instance::Statistics& ScanlineRenderer::getInstanceStatistics() const {
+	return _instanceStatistics;
+}
+
+
+const OverdrawCounters& ScanlineRenderer::getOverdrawCounters() const {
+	return _overdraw;
+}
+
+
+void ScanlineRenderer::setPerfStages(PerfStages* perfStages) {
+	_perfStages = perfStages;
+}
+
+
+void ScanlineRenderer::setDepthSorting(bool enable) {
+	_depthSorting = enable;
+}
+
+
+bool ScanlineRenderer::isDepthSorting() const {
+	return _depthSorting;
+}
+
+
 /*
- * @brief clear scan line data structure rendered
+ * @brief write only the depth in the modes rasterizing with the
+ *        hierarchical zbuffer, the framebuffer keeps its clear color
  */
-void ScanlineRenderer::_clearRenderData() {
-	for (size_t i = 0; i < _classifiedPolygonTable.size(); ++i) {
-		_classifiedPolygonTable[i].clear();
-	}
+void ScanlineRenderer::setDepthOnly(bool enable) {
+	_quadTree->activateDepthOnly(enable);
+}
+
 
-	for (size_t i = 0; i < _classifiedPolygonTable.size(); ++i) {
-		_classifiedEdgeTable[i].clear();
+void ScanlineRenderer::setLodChains(const std::vector<LodChain>* lodChains) {
+	_lodChains = lodChains;
+	_lodLevels.clear();
+	_lodTriangles.clear();
+
+	// the full meshes are the largest selection, so no frame grows the buffer
+	if (_lodChains != nullptr) {
+		size_t triangleCount = 0;
+		for (const auto& chain : *_lodChains) {
+			triangleCount += chain.getLevel(0).triangles.size();
+		}
+		_lodTriangles.reserve(triangleCount);
 	}
+	else {
+		_lodTriangles.shrink_to_fit();
+	}
+	_lodMemory.resize(_lodTriangles.capacity() * sizeof(Triangle));
+}
 
-	_activePolygonTable.clear();
-	_activeEdgeTable.clear();
+
+const std::vector<LodChain>* ScanlineRenderer::getLodChains() const {
+	return _lodChains;
+}
+
+
+void ScanlineRenderer::setLodPixelError(float pixels) {
+	_lodPixelError = pixels;
+}
+
+
+/*
+ * @brief draw the octree nodes whose screen bounds fit into a square of
+ *        pixels as one splat instead of their triangles. The splats are
+ *        drawn after the triangles.
+ * @param pixels edge length of the square, no splats if not positive
+ */
+void ScanlineRenderer::setSplatSize(float pixels) {
+	_splatSize = pixels;
+}
+
+
+uint32_t ScanlineRenderer::getSubmittedTriangleCount() const {
+	return _culler.getStatistics().submitted;
+}
+
+
+uint32_t ScanlineRenderer::getOccludedCount() const {
+	return _occludedCount;
+}
+
+
+uint32_t ScanlineRenderer::getAcceptedCount() const {
+	return _quadTree->getAcceptedCount();
+}
+
+
+const FrameArena& ScanlineRenderer::getFrameArena() const {
+	return _frameArena;
+}
+
+
+uint64_t ScanlineRenderer::getFrameAllocationCount() const {
+	return _frameAllocationCount;
+}
+
+
+/*
+ * @brief clear scan line data structure rendered and reset the frame arena
+ */
+void ScanlineRenderer::_clearRenderData() {
+	// the tables allocate from the arena, destroy them before it is reset
+	_classifiedPolygonTable.clear();
+	_classifiedEdgeTable.clear();
+	_activePolygonTable.reset();
+	_activeEdgeTable.reset();
+	_splats.reset();
+
+	_frameArena.reset();
+
+	_classifiedPolygonTable.resize(_windowHeight, PolygonList(ArenaAllocator<Polygon>(&_frameArena)));
+	_classifiedEdgeTable.resize(_windowHeight, EdgeList(ArenaAllocator<Edge>(&_frameArena)));
+	_activePolygonTable.emplace(ArenaAllocator<Polygon>(&_frameArena));
+	_activeEdgeTable.emplace(ArenaAllocator<ActiveEdgePair>(&_frameArena));
+	_splats.emplace(ArenaAllocator<Splat>(&_frameArena));
 }
 
 
@@ -104,8 +376,8 @@ void ScanlineRenderer::_assembleRenderData(
 		const glm::mat3x3 normalMat = glm::mat3x3(glm::transpose(inverse(modelMat)));
 		const glm::vec3 ambient = 0.1f * lightColor;
 
-		std::vector<Vertex> vertices;
-		std::vector<uint32_t> indices;
+		ArenaVector<Vertex> vertices{ ArenaAllocator<Vertex>(&_frameArena) };
+		ArenaVector<uint32_t> indices{ ArenaAllocator<uint32_t>(&_frameArena) };
 		//std::cout << "before" << std::endl;
 		//std::cout << vertices.size() << std::endl;
 		//std::cout << indices.size() << std::endl;
@@ -166,17 +438,28 @@ void ScanlineRenderer::_assembleRenderData(
 				}
 			}
 
-			std::vector<glm::vec4> points = { v[0], v[1], v[2] };
+			const glm::vec4* points = v;
 
 			Polygon polygon;
 			// to screen position
+			float projectedX[3], projectedY[3];
 			int screenX[3], screenY[3];
 			double screenZ[3];
 
 			for (int j = 0; j < 3; ++j) {
-				screenX[j] = _windowWidth * (points[j].x / points[j].w + 1.0f) / 2.0f;
-				screenY[j] = _windowHeight * (points[j].y / points[j].w + 1.0f) / 2.0f,
-					screenZ[j] = points[j].z / points[j].w;
+				projectedX[j] = _windowWidth * (points[j].x / points[j].w + 1.0f) / 2.0f;
+				projectedY[j] = _windowHeight * (points[j].y / points[j].w + 1.0f) / 2.0f;
+				screenZ[j] = points[j].z / points[j].w;
+			}
+
+			// back-face, zero area and sub pixel culling
+			if (_culler.cull(v, projectedX, projectedY) != Culler::CullResult::Visible) {
+				continue;
+			}
+
+			for (int j = 0; j < 3; ++j) {
+				screenX[j] = static_cast<int>(projectedX[j]);
+				screenY[j] = static_cast<int>(projectedY[j]);
 			}
 
 			//if (i == 3252 || i == 58521) {
@@ -233,7 +516,7 @@ void ScanlineRenderer::_assembleRenderData(
 			// get color(single color without interpolation)
 			glm::vec3 norm = glm::normalize(normalMat * tri[0].normal);
 			glm::vec3 diffuse = std::max(glm::dot(norm, lightDirection), 0.0f) * lightColor;
-			polygon.color = (ambient + diffuse) * objectColor;
+			polygon.color = Framebuffer::packColor((ambient + diffuse) * objectColor);
 			//if ((normalMat * tri[0].normal).z < 0) {
 			//	polygon.color = glm::vec3(1, 0, 0);
 			//}
@@ -293,19 +576,20 @@ void ScanlineRenderer::_scan(Framebuffer& framebuffer) {
 		// for each polygon newly intersect with the scanline
 		for (const auto& polygon : _classifiedPolygonTable[y]) {
 			// add the new polygon in the scan line into the table
-			_activePolygonTable.push_back(polygon);
+			_activePolygonTable->push_back(polygon);
 
-			// find the edge belongs to polygon with polygon.id
-			std::vector<Edge> edges;
+			// find the edge belongs to polygon with polygon.id, a triangle has 3 at most
+			Edge edges[3];
+			size_t edgeCount = 0;
 			for (const auto& edge : _classifiedEdgeTable[y]) {
-				if (edge.id == polygon.id && edge.dy > 0) { // drop 3 edge condition
-					edges.push_back(edge);
+				if (edge.id == polygon.id && edge.dy > 0 && edgeCount < 3) { // drop 3 edge condition
+					edges[edgeCount++] = edge;
 				}
 			}
 
-			assert(edges.size() == 2);
+			assert(edgeCount == 2);
 
-			if (edges.empty()) {
+			if (edgeCount < 2) {
 				continue;
 			}
 
@@ -332,21 +616,31 @@ void ScanlineRenderer::_scan(Framebuffer& framebuffer) {
 			edgePair.dzy = polygon.b / polygon.c;
 			edgePair.id = polygon.id;
 
-			_activeEdgeTable.push_back(edgePair);
+			_activeEdgeTable->push_back(edgePair);
 		}
 
 		// for each edgePair
-		for (auto edgePairIt = _activeEdgeTable.begin(); edgePairIt != _activeEdgeTable.end();) {
+		for (auto edgePairIt = _activeEdgeTable->begin(); edgePairIt != _activeEdgeTable->end();) {
 			// get the polygon the edge belong to
 			Polygon* pPolygon = _findActivePolygon(edgePairIt->id);
 
 			assert(pPolygon != nullptr);
 
 			// update framebuffer & zbuffer
+			const int xMin = std::max(static_cast<int>(edgePairIt->xl), 0);
+			const int xMax = std::min(static_cast<int>(edgePairIt->xr), _windowWidth) - 1;
+			if (xMin <= xMax) {
+				_zbuffer->touchSpan(y, xMin, xMax);
+				framebuffer.touchSpan(y, xMin, xMax);
+			}
+
 			float zx = edgePairIt->zl;
 			for (int x = edgePairIt->xl; x < (int)edgePairIt->xr; ++x) {
 				if (x >= 0 && x < _windowWidth) {
+					OVERDRAW_COUNT_TEST(&_overdraw, y * _windowWidth + x);
 					if (_zbuffer->testAndSet(x, y, zx)) {
+						OVERDRAW_COUNT_PASS(&_overdraw, y * _windowWidth + x);
+						OVERDRAW_COUNT_WRITE(&_overdraw, y * _windowWidth + x);
 						framebuffer.setPixel(x, y, pPolygon->color);
 					}
 				}
@@ -363,22 +657,23 @@ void ScanlineRenderer::_scan(Framebuffer& framebuffer) {
 
 			// exchange outdated edges with new edges in the same polygon
 			if ((edgePairIt->dyl <= 0 || edgePairIt->dyr <= 0) && y >= 1) {
-				std::vector<Edge> candidateEdges;
+				Edge candidateEdges[2];
+				size_t candidateEdgeCount = 0;
 				for (const auto& edge : _classifiedEdgeTable[static_cast<size_t>(y) - 1]) {
 					if (edge.id == edgePairIt->id) {
-						candidateEdges.push_back(edge);
-						if ((edgePairIt->dyl > 0 || edgePairIt->dyr > 0) || candidateEdges.size() > 1) {
+						candidateEdges[candidateEdgeCount++] = edge;
+						if ((edgePairIt->dyl > 0 || edgePairIt->dyr > 0) || candidateEdgeCount > 1) {
 							break;
 						}
 					}
 				}
 
-				if (candidateEdges.empty()) {
-					_activeEdgeTable.erase(edgePairIt++);
+				if (candidateEdgeCount == 0) {
+					_activeEdgeTable->erase(edgePairIt++);
 					continue;
 				}
 
-				if (candidateEdges.size() == 1) {
+				if (candidateEdgeCount == 1) {
 					if (edgePairIt->dyl <= 0) {
 						Polygon* pPolygon = _findActivePolygon(edgePairIt->id);
 						assert(pPolygon != nullptr);
@@ -404,10 +699,10 @@ void ScanlineRenderer::_scan(Framebuffer& framebuffer) {
 		}
 
 		// update active polygon table
-		for (auto it = _activePolygonTable.begin(); it != _activePolygonTable.end();) {
+		for (auto it = _activePolygonTable->begin(); it != _activePolygonTable->end();) {
 			it->dy -= 1;
 			if (it->dy < 0) {
-				_activePolygonTable.erase(it++);
+				_activePolygonTable->erase(it++);
 			}
 			else {
 				++it;
@@ -418,7 +713,7 @@ void ScanlineRenderer::_scan(Framebuffer& framebuffer) {
 
 
 Polygon* ScanlineRenderer::_findActivePolygon(int id) {
-	for (auto& polygon : _activePolygonTable) {
+	for (auto& polygon : *_activePolygonTable) {
 		if (polygon.id == id) {
 			return &polygon;
 		}
@@ -433,15 +728,24 @@ void ScanlineRenderer::_renderWithHierarchicalZBuffer(
 	const glm::vec3& objectColor,
 	const glm::vec3& lightColor,
 	const glm::vec3& lightDirection) {
-	glm::mat4x4 model = glm::mat4x4(1.0f);
-	glm::mat4x4 view = camera.getViewMatrix();
-	glm::mat4x4 projection = camera.getProjectionMatrix();
-
-	for (int i = 0; i < _triangles.size(); ++i) {
-		if (_quadTree->handleTriangle(_triangles[i],
-			model, view, projection, objectColor, lightColor, lightDirection)) {
+	// the triangles are in world space, the model matrix is the identity
+	const glm::mat4x4 view = camera.getViewMatrix();
+	const glm::mat4x4 mvp = camera.getProjectionMatrix() * view;
+	const glm::mat3x3 normalMatrix = glm::mat3x3(1.0f);
+
+	const uint32_t* order = _getDepthOrder(view);
+
+	PROFILE_ZONE("raster");
+	PerfStages::Scope perfStage(_perfStages, "raster");
+	uint32_t rejectedCount = 0;
+	for (size_t i = 0; i < _frameTriangles->size(); ++i) {
+		if (_quadTree->handleTriangle((*_frameTriangles)[order != nullptr ? order[i] : i],
+			mvp, normalMatrix, objectColor, lightColor, lightDirection)) {
+			++rejectedCount;
 		}
 	}
+
+	_countOccluded(rejectedCount);
 }
 
 
@@ -450,52 +754,186 @@ void ScanlineRenderer::_renderWithOctreeHierarchicalZBuffer(
 	const glm::vec3& objectColor,
 	const glm::vec3& lightColor,
 	const glm::vec3& lightDirection) {
-	const glm::mat4x4 model = glm::mat4x4(1.0f);
 	const glm::mat4x4 view = camera.getViewMatrix();
 	const glm::mat4x4 projection = camera.getProjectionMatrix();
 	const glm::mat4x4 vp = projection * view;
+	const glm::mat3x3 normalMatrix = glm::mat3x3(1.0f);
+
+	// the nodes of a cell are decoded once the camera enters it, the view
+	// matrix takes the local position as the eye
+	const std::vector<bool>* visibleNodes = nullptr;
+	if (_visibleSet != nullptr) {
+		const int cell = _visibleSet->getCell(camera.getLocalPosition());
+		if (cell >= 0 && cell != _visibleSetCell) {
+			_visibleSet->getVisibleNodes(cell, _visibleSetNodes);
+		}
+		_visibleSetCell = cell;
+		visibleNodes = cell >= 0 ? &_visibleSetNodes : nullptr;
+	}
+
+	PROFILE_ZONE("octree traversal");
+	PerfStages::Scope perfStage(_perfStages, "octree traversal");
+	_countOccluded(_drawOctree(*_octree, vp, normalMatrix, Frustum::allPlanes,
+		visibleNodes, _visibleNodeRecord, objectColor, lightColor, lightDirection));
+	_drawSplats();
+}
 
-	std::stack<OctreeZNode> stack;
-	bool flag = _octree->getRoot()->childExists > 0 ? false : true;
-	glm::vec4 rootCenter = vp * glm::vec4{ _octree->getRoot()->box->center, 1.0f };
 
-	stack.push(OctreeZNode{ flag, rootCenter.z / rootCenter.w, _octree->getRoot() });
+/*
+ * @brief draw the triangles of an octree front to back, skipping the nodes
+ *        outside of the view frustum or behind the hierarchical zbuffer
+ * @detail the octree is in model space, the frustum planes are taken to it
+ *         by the model view projection matrix. The nodes are tested with
+ *         their tight bounds, so a refit octree needs no rebuild. Every
+ *         stack entry keeps the nearest depth of the boxes up to the bottom
+ *         of the stack, the traversal ends once it is behind the covered
+ *         depth of the screen. A node small enough on the screen may be
+ *         drawn as a splat, see setSplatSize.
+ * @param planeMask frustum planes the octree may cross, see Frustum::intersectsBox
+ * @param visibleNodes nodes to traverse by OctreeNode::index, null for all
+ * @param visibleNodeRecord nodes drawn by OctreeNode::index, null if not recorded
+ * @return triangles rejected by the hierarchical zbuffer
+ */
+uint32_t ScanlineRenderer::_drawOctree(
+	const Octree& octree,
+	const glm::mat4x4& mvp,
+	const glm::mat3x3& normalMatrix,
+	uint8_t planeMask,
+	const std::vector<bool>* visibleNodes,
+	std::vector<bool>* visibleNodeRecord,
+	const glm::vec3& objectColor,
+	const glm::vec3& lightColor,
+	const glm::vec3& lightDirection) {
+	const Frustum frustum(mvp);
+	const ArenaAllocator<OctreeZNode> allocator(&_frameArena);
+	std::stack<OctreeZNode, ArenaVector<OctreeZNode>> stack{ ArenaVector<OctreeZNode>(allocator) };
+	// a parent and its 8 children at most, reused for every node
+	ArenaVector<OctreeZNode> children(allocator);
+	children.reserve(9);
+
+	// the planes a node is inside of hold for its whole subtree
+	auto cullNode = [&](const OctreeNode* node, uint8_t& planeMask) {
+		++_octreeStatistics.visited;
+		// no triangles below the node
+		if (node->minPoint.x > node->maxPoint.x) {
+			return true;
+		}
+
+		if (visibleNodes != nullptr && !(*visibleNodes)[node->index]) {
+			++_octreeStatistics.potentiallyVisible;
+			return true;
+		}
+
+		if (planeMask == 0) {
+			return false;
+		}
+
+		const glm::vec3 center = 0.5f * (node->minPoint + node->maxPoint);
+		if (!frustum.intersectsBox(center, 0.5f * (node->maxPoint - node->minPoint), planeMask)) {
+			++_octreeStatistics.frustum;
+			return true;
+		}
+
+		if (planeMask == 0) {
+			++_octreeStatistics.inside;
+		}
+		return false;
+	};
+
+	auto getDepth = [&](const OctreeNode* node) {
+		const glm::vec4 center = mvp * glm::vec4(0.5f * (node->minPoint + node->maxPoint), 1.0f);
+		return center.z / center.w;
+	};
+
+	// the corners are the clip position of the min point plus the columns scaled by the extent
+	auto getNearestDepth = [&](const OctreeNode* node) {
+		const glm::vec3 extent = node->maxPoint - node->minPoint;
+		const glm::vec4 origin = mvp * glm::vec4(node->minPoint, 1.0f);
+		float minZ = std::numeric_limits<float>::max();
+		for (int i = 0; i < 8; ++i) {
+			const glm::vec4 clip = origin +
+				mvp[0] * (i & 1 ? extent.x : 0.0f) +
+				mvp[1] * (i & 2 ? extent.y : 0.0f) +
+				mvp[2] * (i & 4 ? extent.z : 0.0f);
+			if (clip.w <= 0.0f) {
+				return std::numeric_limits<float>::lowest();
+			}
+			minZ = std::min(minZ, clip.z / clip.w);
+		}
+		return minZ;
+	};
+
+	auto push = [&](OctreeZNode entry) {
+		entry.stackMinZ = getNearestDepth(entry.node);
+		if (!stack.empty()) {
+			entry.stackMinZ = std::min(entry.stackMinZ, stack.top().stackMinZ);
+		}
+		stack.push(entry);
+	};
+
+	uint8_t rootMask = planeMask;
+	if (cullNode(octree.getRoot(), rootMask)) {
+		return 0;
+	}
+
+	bool flag = octree.getRoot()->childExists > 0 ? false : true;
+	push(OctreeZNode{ flag, getDepth(octree.getRoot()), octree.getRoot(), rootMask });
+
+	uint32_t rejectedCount = 0;
 	while (!stack.empty()) {
+		if (stack.top().stackMinZ >= _quadTree->getCoveredDepth()) {
+			_octreeStatistics.covered += static_cast<uint32_t>(stack.size());
+			break;
+		}
+
 		OctreeZNode parent = stack.top();
 		stack.pop();
 
-		std::vector<OctreeZNode> children;
+		children.clear();
+
+		// an inner node marked as leaf only draws its own triangles after its children
+		if (_splatSize > 0.0f && (!parent.isLeaf || parent.node->childExists == 0) &&
+			_drawSplat(parent.node, mvp, normalMatrix, objectColor, lightColor, lightDirection)) {
+			++_octreeStatistics.splatted;
+			continue;
+		}
 
 		if (parent.isLeaf) {
-			int screenX, screenY, screenZ, screenRadius;
-			glm::vec4 vCenter = vp * glm::vec4{ parent.node->box->center, 1.0f };
-			screenX = int((vCenter.x / vCenter.w + 1.0f) * _windowWidth / 2);
-			screenY = int((vCenter.y / vCenter.w + 1.0f) * _windowHeight / 2);
-
-			glm::vec3 v = parent.node->box->center +
-				glm::vec3(1.0f, 0.0f, 0.0f) * parent.node->box->halfSide * 1.73206f;
-			glm::vec4 u = vp * glm::vec4(v, 1.0f);
-			screenRadius = int((u.x / u.w + 1.0f) * _windowWidth / 2) - screenX;
-			v = parent.node->box->center + glm::vec3(0.0f, 0.0f, 1.0f) * parent.node->box->halfSide * 1.73206f;
-			u = vp * glm::vec4(v, 1.0f);
-			screenZ = u.z / u.w;
-
-			QuadTreeNode* node = _quadTree->searchNode(screenX, screenY, screenRadius);
-			if (node->z > screenZ) {
+			if (_isBoxVisible(parent.node->minPoint, parent.node->maxPoint, mvp)) {
+				PROFILE_ZONE_DETAIL("octree leaf");
+				if (visibleNodeRecord != nullptr) {
+					// the ancestors are marked as well, so the subtree is reached from the root
+					for (uint32_t lc = parent.node->locCode; lc >= 1; lc >>= 3) {
+						const uint32_t index = octree.findNode(lc)->index;
+						if ((*visibleNodeRecord)[index]) {
+							break;
+						}
+						(*visibleNodeRecord)[index] = true;
+					}
+				}
+
 				for (auto iter : parent.node->objects) {
-					_quadTree->handleTriangle(*iter, model, view, projection,
-						objectColor, lightColor, lightDirection);
+					if (_quadTree->handleTriangle(*iter, mvp, normalMatrix,
+						objectColor, lightColor, lightDirection)) {
+						++rejectedCount;
+					}
 				}
+			} else {
+				++_octreeStatistics.occluded;
 			}
 		}
 		else {
 			for (int i = 0; i < 8; ++i) {
 				if (parent.node->childExists & (1 << i)) {
 					uint32_t locCodeChild = (parent.node->locCode << 3) | i;
-					OctreeNode* childNode = _octree->lookupNode(locCodeChild);
-					glm::vec4 vCenter = vp * glm::vec4(childNode->box->center, 1.0f);
+					const OctreeNode* childNode = octree.findNode(locCodeChild);
+					uint8_t planeMask = parent.planeMask;
+					if (cullNode(childNode, planeMask)) {
+						continue;
+					}
+
 					bool flag = childNode->childExists > 0 ? false : true;
-					children.push_back(OctreeZNode{ flag, vCenter.z / vCenter.w, childNode });
+					children.push_back(OctreeZNode{ flag, getDepth(childNode), childNode, planeMask });
 				}
 			}
 			parent.isLeaf = true;
@@ -507,9 +945,420 @@ void ScanlineRenderer::_renderWithOctreeHierarchicalZBuffer(
 		});
 
 		for (auto it = children.rbegin(); it != children.rend(); ++it) {
-			stack.push(*it);
+			push(*it);
+		}
+	}
+
+	return rejectedCount;
+}
+
+
+/*
+ * @brief rasterize the depth and the triangle ids, no shading
+ */
+void ScanlineRenderer::_renderWithVisibilityBuffer(const Camera& camera) {
+	const glm::mat4x4 view = camera.getViewMatrix();
+	const glm::mat4x4 mvp = camera.getProjectionMatrix() * view;
+	const uint32_t* order = _getDepthOrder(view);
+
+	PROFILE_ZONE("raster");
+	PerfStages::Scope perfStage(_perfStages, "raster");
+	uint32_t rejectedCount = 0;
+	for (size_t i = 0; i < _frameTriangles->size(); ++i) {
+		const uint32_t triangleId = order != nullptr ? order[i] : static_cast<uint32_t>(i);
+		if (_quadTree->handleTriangle((*_frameTriangles)[triangleId], triangleId, mvp)) {
+			++rejectedCount;
+		}
+	}
+
+	_countOccluded(rejectedCount);
+}
+
+
+/*
+ * @brief render the clusters that pass the frustum, normal cone and depth
+ *        tests with the hierarchical zbuffer, triangle by triangle
+ */
+void ScanlineRenderer::_renderWithClusters(
+	const Camera& camera,
+	const glm::vec3& objectColor,
+	const glm::vec3& lightColor,
+	const glm::vec3& lightDirection) {
+	const glm::mat4x4 view = camera.getViewMatrix();
+	const glm::mat4x4 vp = camera.getProjectionMatrix() * view;
+	const glm::mat3x3 normalMatrix = glm::mat3x3(1.0f);
+	const glm::vec3 eye = glm::vec3(glm::inverse(view)[3]);
+	const Frustum frustum(vp);
+
+	const auto& clusters = _clusters->getClusters();
+	const uint32_t* triangleIndices = _clusters->getTriangleIndices();
+	const uint32_t clusterCount = static_cast<uint32_t>(clusters.size());
+
+	// few clusters, a comparison sort by the nearest depth of the spheres is cheap
+	uint32_t* order = nullptr;
+	if (_depthSorting) {
+		PROFILE_ZONE("cluster sort");
+		PerfStages::Scope perfStage(_perfStages, "cluster sort");
+		const glm::vec4 depthRow = -glm::vec4(view[0][2], view[1][2], view[2][2], view[3][2]);
+		float* depths = _frameArena.allocateArray<float>(clusterCount);
+		order = _frameArena.allocateArray<uint32_t>(clusterCount);
+		for (uint32_t i = 0; i < clusterCount; ++i) {
+			depths[i] = glm::dot(depthRow, glm::vec4(clusters[i].center, 1.0f)) - clusters[i].radius;
+			order[i] = i;
+		}
+
+		std::sort(order, order + clusterCount, [depths](uint32_t a, uint32_t b) {
+			return depths[a] < depths[b];
+		});
+	}
+
+	PROFILE_ZONE("raster");
+	PerfStages::Scope perfStage(_perfStages, "raster");
+	uint32_t rejectedCount = 0;
+	for (uint32_t i = 0; i < clusterCount; ++i) {
+		const Cluster& cluster = clusters[order != nullptr ? order[i] : i];
+		++_clusterStatistics.submitted;
+
+		if (!ClusterSet::isInFrustum(cluster, frustum)) {
+			++_clusterStatistics.frustum;
+			continue;
+		}
+
+		if (_culler.getCullFace() == Culler::CullFace::Back && ClusterSet::isBackFacing(cluster, eye)) {
+			++_clusterStatistics.backFace;
+			continue;
+		}
+
+		if (!_isBoxVisible(cluster.minPoint, cluster.maxPoint, vp)) {
+			++_clusterStatistics.occluded;
+			continue;
+		}
+
+		for (uint32_t j = cluster.first; j < cluster.first + cluster.count; ++j) {
+			if (_quadTree->handleTriangle(_triangles[triangleIndices[j]],
+				vp, normalMatrix, objectColor, lightColor, lightDirection)) {
+				++rejectedCount;
+			}
+		}
+	}
+
+	_countOccluded(rejectedCount);
+}
+
+
+/*
+ * @brief draw the instances front to back through the scene tree
+ * @detail the nodes of the tree are tested against the view frustum, with
+ *         the plane masks inherited from their parents, and against the
+ *         hierarchical zbuffer. A visible instance draws the local octree of
+ *         its geometry with its model view projection matrix, nothing is
+ *         copied per instance.
+ */
+void ScanlineRenderer::_renderWithInstances(
+	const Camera& camera,
+	const glm::vec3& objectColor,
+	const glm::vec3& lightColor,
+	const glm::vec3& lightDirection) {
+	if (_sceneTree == nullptr || _sceneTree->getNodes().empty()) {
+		return;
+	}
+
+	{
+		PROFILE_ZONE("scene tree refit");
+		_sceneTree->update();
+	}
+
+	const glm::mat4x4 view = camera.getViewMatrix();
+	const glm::mat4x4 vp = camera.getProjectionMatrix() * view;
+	const Frustum frustum(vp);
+	const glm::vec4 depthRow = -glm::vec4(view[0][2], view[1][2], view[2][2], view[3][2]);
+	const auto& nodes = _sceneTree->getNodes();
+	_instanceStatistics.submitted = nodes[0].instanceCount;
+
+	PROFILE_ZONE("raster");
+	PerfStages::Scope perfStage(_perfStages, "raster");
+	struct Entry {
+		int32_t node;
+		uint8_t planeMask;
+	};
+	std::stack<Entry, ArenaVector<Entry>> stack{ ArenaVector<Entry>(ArenaAllocator<Entry>(&_frameArena)) };
+	stack.push(Entry{ 0, Frustum::allPlanes });
+
+	uint32_t rejectedCount = 0;
+	while (!stack.empty()) {
+		Entry entry = stack.top();
+		stack.pop();
+
+		const SceneTree::Node& node = nodes[entry.node];
+		const glm::vec3 center = 0.5f * (node.minPoint + node.maxPoint);
+		if (!frustum.intersectsBox(center, 0.5f * (node.maxPoint - node.minPoint), entry.planeMask)) {
+			_instanceStatistics.frustum += node.instanceCount;
+			continue;
+		}
+
+		if (!_isBoxVisible(node.minPoint, node.maxPoint, vp)) {
+			_instanceStatistics.occluded += node.instanceCount;
+			continue;
+		}
+
+		if (node.left >= 0) {
+			// the nearer child is popped first
+			const float leftDepth = glm::dot(depthRow, glm::vec4(
+				0.5f * (nodes[node.left].minPoint + nodes[node.left].maxPoint), 1.0f));
+			const float rightDepth = glm::dot(depthRow, glm::vec4(
+				0.5f * (nodes[node.right].minPoint + nodes[node.right].maxPoint), 1.0f));
+			const bool leftFirst = leftDepth <= rightDepth;
+			stack.push(Entry{ leftFirst ? node.right : node.left, entry.planeMask });
+			stack.push(Entry{ leftFirst ? node.left : node.right, entry.planeMask });
+			continue;
+		}
+
+		const Instance& instance = (*_instances)[node.instance];
+		const glm::mat4x4 modelMatrix = instance.getModelMatrix();
+		const glm::mat4x4 mvp = vp * modelMatrix;
+		const glm::mat3x3 normalMatrix = glm::mat3x3(glm::transpose(glm::inverse(modelMatrix)));
+		rejectedCount += _drawOctree(*instance.getGeometry()->getOctree(), mvp, normalMatrix, entry.planeMask,
+			nullptr, nullptr, objectColor, lightColor, lightDirection);
+	}
+
+	_countOccluded(rejectedCount);
+	_drawSplats();
+}
+
+
+/*
+ * @brief test the screen bounds of a world space box against the hierarchical zbuffer
+ * @detail the corners of the box give the screen rectangle and the nearest
+ *         depth. A box reaching behind the eye is never rejected.
+ * @return false if the box is behind the zbuffer
+ */
+bool ScanlineRenderer::_isBoxVisible(const glm::vec3& minPoint, const glm::vec3& maxPoint, const glm::mat4x4& vp) {
+	glm::vec4 bounds;
+	float minZ, maxZ;
+	if (!_projectBox(minPoint, maxPoint, vp, bounds, minZ, maxZ)) {
+		return true;
+	}
+
+	const glm::ivec4 rect = _getPixelRect(bounds);
+	return _quadTree->testRect(rect.x, rect.y, rect.z, rect.w, minZ);
+}
+
+
+/*
+ * @brief project the corners of a box to the screen
+ * @param bounds set to the smallest x and y and the largest x and y in pixels
+ * @param minZ, maxZ set to the nearest and the farthest depth
+ * @return false if the box reaches behind the eye
+ */
+bool ScanlineRenderer::_projectBox(const glm::vec3& minPoint, const glm::vec3& maxPoint, const glm::mat4x4& vp,
+	glm::vec4& bounds, float& minZ, float& maxZ) const {
+	bounds = glm::vec4(glm::vec2(std::numeric_limits<float>::max()), glm::vec2(std::numeric_limits<float>::lowest()));
+	minZ = std::numeric_limits<float>::max();
+	maxZ = std::numeric_limits<float>::lowest();
+	for (int i = 0; i < 8; ++i) {
+		const glm::vec3 corner(
+			i & 1 ? maxPoint.x : minPoint.x,
+			i & 2 ? maxPoint.y : minPoint.y,
+			i & 4 ? maxPoint.z : minPoint.z);
+		const glm::vec4 clip = vp * glm::vec4(corner, 1.0f);
+		if (clip.w <= 0.0f) {
+			return false;
+		}
+
+		const float x = (clip.x / clip.w + 1.0f) * _windowWidth / 2;
+		const float y = (clip.y / clip.w + 1.0f) * _windowHeight / 2;
+		bounds.x = std::min(bounds.x, x);
+		bounds.y = std::min(bounds.y, y);
+		bounds.z = std::max(bounds.z, x);
+		bounds.w = std::max(bounds.w, y);
+		minZ = std::min(minZ, clip.z / clip.w);
+		maxZ = std::max(maxZ, clip.z / clip.w);
+	}
+
+	return true;
+}
+
+
+/*
+ * @brief get the inclusive pixel bounds of projected bounds on the screen
+ */
+glm::ivec4 ScanlineRenderer::_getPixelRect(const glm::vec4& bounds) const {
+	// the triangles snap their vertices by truncation, so do the bounds
+	return glm::ivec4(
+		std::clamp(static_cast<int>(std::floor(bounds.x)), 0, _windowWidth - 1),
+		std::clamp(static_cast<int>(std::floor(bounds.y)), 0, _windowHeight - 1),
+		std::clamp(static_cast<int>(bounds.z), 0, _windowWidth - 1),
+		std::clamp(static_cast<int>(bounds.w), 0, _windowHeight - 1));
+}
+
+
+/*
+ * @brief queue an octree node as one splat if its screen bounds are small enough
+ * @detail the splat colors the pixels of the bounds of the box in front of
+ *         its nearest depth. The triangles may cover only some of these
+ *         pixels, so the splat writes no depth and hides nothing behind it
+ *         in the zbuffer or the hierarchy. It is queued until the traversal
+ *         ends, a farther node drawn later would paint over it otherwise.
+ *         It is shaded as a triangle with the averaged normal of the subtree.
+ * @return true if the node is queued, its subtree is done
+ */
+bool ScanlineRenderer::_drawSplat(
+	const OctreeNode* node,
+	const glm::mat4x4& mvp,
+	const glm::mat3x3& normalMatrix,
+	const glm::vec3& objectColor,
+	const glm::vec3& lightColor,
+	const glm::vec3& lightDirection) {
+	glm::vec4 bounds;
+	float minZ, maxZ;
+	if (!_projectBox(node->minPoint, node->maxPoint, mvp, bounds, minZ, maxZ) ||
+		bounds.z - bounds.x > _splatSize || bounds.w - bounds.y > _splatSize) {
+		return false;
+	}
+
+	// behind the near plane or off the screen, nothing to draw
+	if (minZ < -1.0f || bounds.z < 0.0f || bounds.w < 0.0f ||
+		bounds.x >= _windowWidth || bounds.y >= _windowHeight) {
+		return true;
+	}
+
+	const glm::ivec4 rect = _getPixelRect(bounds);
+	if (!_quadTree->testRect(rect.x, rect.y, rect.z, rect.w, minZ)) {
+		++_octreeStatistics.occluded;
+		return true;
+	}
+
+	const glm::vec3 ambient = 0.1f * lightColor;
+	const glm::vec3 norm = glm::length(node->normal) > 0.0f ?
+		glm::normalize(normalMatrix * node->normal) : glm::vec3(0.0f);
+	const glm::vec3 diffuse = std::max(glm::dot(lightDirection, norm), 0.0f) * lightColor;
+	_splats->push_back(Splat{ rect, minZ, Framebuffer::packColor((ambient + diffuse) * objectColor) });
+	return true;
+}
+
+
+/*
+ * @brief draw the queued splats against the final zbuffer
+ * @detail every triangle is drawn by now, so a splat only colors the pixels
+ *         in front of the nearest surface. The splats overlap each other
+ *         without depth, they are queued about front to back and drawn in
+ *         reverse, so the nearer one wins.
+ */
+void ScanlineRenderer::_drawSplats() {
+	PROFILE_ZONE("splats");
+	for (auto it = _splats->rbegin(); it != _splats->rend(); ++it) {
+		_quadTree->handleRect(it->rect.x, it->rect.y, it->rect.z, it->rect.w, it->z, it->color);
+	}
+}
+
+
+/*
+ * @brief select the level of detail of every model
+ * @detail the triangles are in world space as loaded, so the eye is taken to
+ *         model space by the identity. The selected triangles are only copied
+ *         when a level changes.
+ * @return triangles of the selected levels, _triangles without chains
+ */
+const std::vector<Triangle>* ScanlineRenderer::_selectLods(const Camera& camera) {
+	if (_lodChains == nullptr) {
+		return &_triangles;
+	}
+
+	PROFILE_ZONE("lod selection");
+	const glm::vec3 eye = glm::vec3(glm::inverse(camera.getViewMatrix())[3]);
+	const float pixelsPerUnit = camera.getProjectionMatrix()[1][1] * _windowHeight / 2.0f;
+
+	bool changed = _lodLevels.size() != _lodChains->size();
+	_lodLevels.resize(_lodChains->size(), -1);
+	for (size_t i = 0; i < _lodChains->size(); ++i) {
+		const int level = (*_lodChains)[i].selectLevel(eye, pixelsPerUnit, _lodPixelError);
+		if (level != _lodLevels[i]) {
+			_lodLevels[i] = level;
+			changed = true;
 		}
 	}
+
+	if (changed) {
+		_lodTriangles.clear();
+		for (size_t i = 0; i < _lodChains->size(); ++i) {
+			const auto& triangles = (*_lodChains)[i].getLevel(_lodLevels[i]).triangles;
+			_lodTriangles.insert(_lodTriangles.end(), triangles.begin(), triangles.end());
+		}
+	}
+
+	return &_lodTriangles;
+}
+
+
+/*
+ * @brief get the front to back order of the triangles if depth sorting is enabled
+ * @return triangle indices in the frame arena, null to keep the file order
+ */
+const uint32_t* ScanlineRenderer::_getDepthOrder(const glm::mat4x4& view) {
+	if (!_depthSorting) {
+		return nullptr;
+	}
+
+	PerfStages::Scope perfStage(_perfStages, "depth sort");
+	return DepthSort::sortFrontToBack(*_frameTriangles, view, _frameArena);
+}
+
+
+/*
+ * @brief keep the rejected triangles the culling stage did not reject
+ */
+void ScanlineRenderer::_countOccluded(uint32_t rejectedCount) {
+	const Culler::Statistics& statistics = _culler.getStatistics();
+	_occludedCount = rejectedCount - (statistics.backFace + statistics.zeroArea + statistics.subPixel + statistics.nearPlane);
+}
+
+
+/*
+ * @brief shade every covered pixel once from its triangle id,
+ *        rows of tiles are resolved in parallel
+ * @detail only tiles touched by the rasterization hold triangle ids, the
+ *         others keep the clear color of the framebuffer
+ */
+void ScanlineRenderer::_resolveVisibilityBuffer(
+	Framebuffer& framebuffer,
+	const glm::vec3& objectColor,
+	const glm::vec3& lightColor,
+	const glm::vec3& lightDirection) {
+	const ClearTiles& tiles = _quadTree->getDepthTiles();
+	const uint32_t* triangleIds = _quadTree->getTriangleIds();
+	const glm::vec3 ambient = 0.1f * lightColor;
+
+	// a tile row belongs to a single job, so are the framebuffer tiles touched
+	PROFILE_ZONE("resolve");
+	JobSystem::get().parallelFor(0, tiles.getTileCountY(), 1, [&](int tileY) {
+		PROFILE_ZONE_DETAIL("resolve tile row");
+		const int yl = tileY * ClearTiles::tileHeight;
+		const int yr = std::min(yl + ClearTiles::tileHeight, _windowHeight);
+		for (int tileX = 0; tileX < tiles.getTileCountX(); ++tileX) {
+			if (!tiles.isTouched(tileX, tileY)) {
+				continue;
+			}
+
+			const int xl = tileX * ClearTiles::tileWidth;
+			const int xr = std::min(xl + ClearTiles::tileWidth, _windowWidth);
+			framebuffer.touchSpan(yl, xl, xr - 1);
+
+			for (int y = yl; y < yr; ++y) {
+				const uint32_t* row = triangleIds + y * _windowWidth;
+				for (int x = xl; x < xr; ++x) {
+					if (row[x] == QuadTree::invalidTriangleId) {
+						continue;
+					}
+
+					// model matrix is the identity, see _renderWithVisibilityBuffer
+					const glm::vec3 norm = glm::normalize((*_frameTriangles)[row[x]].v[0].normal);
+					const glm::vec3 diffuse = std::max(glm::dot(lightDirection, norm), 0.0f) * lightColor;
+					OVERDRAW_COUNT_WRITE(&_overdraw, y * _windowWidth + x);
+					framebuffer.setPixel(x, y, Framebuffer::packColor((ambient + diffuse) * objectColor));
+				}
+			}
+		}
+	});
 }
 
 
@@ -1,17 +1,28 @@
 #pragma once
 
 #include <list>
+#include <optional>
 #include <vector>
 
 #include <glm/mat4x4.hpp>
 
+#include "core/frame_arena.h"
+#include "core/perf_counters.h"
+
 #include "mesh.h"
 #include "model.h"
 #include "camera.h"
 #include "clipper.h"
+#include "cluster.h"
+#include "culler.h"
+#include "instance.h"
+#include "lod_chain.h"
+#include "overdraw.h"
 #include "zbuffer.h"
 #include "quadtree.h"
 #include "octree.h"
+#include "potentially_visible_set.h"
+#include "scene_tree.h"
 #include "framebuffer.h"
 #include "scanline_renderer.h"
 
@@ -21,8 +32,8 @@ struct Polygon {
 	int id;
 	// number of scan line contained
 	int dy;
-	// render color of the polygon
-	glm::vec3 color;
+	// render color of the polygon, packed once per polygon
+	uint32_t color;
 };
 
 
@@ -53,6 +64,21 @@ struct ActiveEdgePair {
 	int id;
 };
 
+
+struct Splat {
+	/* pixel rectangle, inclusive */
+	glm::ivec4 rect;
+	/* nearest depth of the box */
+	float z;
+	/* shaded color, packed */
+	uint32_t color;
+};
+
+/* scan line tables, their nodes live in the frame arena */
+using PolygonList = std::list<Polygon, ArenaAllocator<Polygon>>;
+using EdgeList = std::list<Edge, ArenaAllocator<Edge>>;
+using ActiveEdgePairList = std::list<ActiveEdgePair, ArenaAllocator<ActiveEdgePair>>;
+
 class ScanlineRenderer {
 public:
 	enum class RenderMode {
@@ -60,6 +86,12 @@ public:
 		ZBuffer,
 		HierarchicalZBuffer,
 		OctreeHierarchicalZBuffer,
+		/* hierarchical zbuffer with triangle ids, shaded once per pixel afterwards */
+		VisibilityBuffer,
+		/* hierarchical zbuffer with clusters culled by frustum, normal cone and depth */
+		Cluster,
+		/* hierarchical zbuffer over the instances, culled by frustum and depth */
+		Instanced,
 	};
 
 	ScanlineRenderer(Framebuffer& framebuffer,
@@ -67,6 +99,8 @@ public:
 		std::vector<Triangle>& triangles,
 		const glm::vec4& clearColor);
 
+	~ScanlineRenderer();
+
 	void render(
 		Framebuffer& framebuffer,
 		const Camera& camera,
@@ -77,8 +111,143 @@ public:
 
 	enum RenderMode getRenderMode() const;
 
+	/*
+	 * @brief get the short name of a render mode, e.g. for command lines and reports
+	 */
+	static const char* getRenderModeName(enum RenderMode renderMode);
+
 	void setRenderMode(enum RenderMode renderMode);
 
+	/*
+	 * @brief get the triangle culling stage shared by all render modes
+	 */
+	Culler& getCuller();
+
+	/*
+	 * @brief get the culling counters of the last rendered frame
+	 */
+	const Culler::Statistics& getCullStatistics() const;
+
+	/*
+	 * @brief get the cluster culling counters of the last rendered frame
+	 */
+	const ClusterSet::Statistics& getClusterStatistics() const;
+
+	/*
+	 * @brief get the octree node counters of the last rendered frame
+	 */
+	const Octree::Statistics& getOctreeStatistics() const;
+
+	/*
+	 * @brief set the instances rendered by the instanced mode
+	 * @param instances instances in any order, null to render none
+	 */
+	void setInstances(const std::vector<Instance>* instances);
+
+	/*
+	 * @brief get the tree over the instances, mark moved instances in it
+	 * @return null without instances
+	 */
+	SceneTree* getSceneTree();
+
+	/*
+	 * @brief skip the octree nodes the camera cell cannot see in the octree
+	 *        mode, the whole octree is traversed outside of the cells
+	 * @param visibleSet set built from the same triangles, null to traverse the whole octree
+	 * @exception std::invalid_argument if the set was built for another octree
+	 */
+	void setPotentiallyVisibleSet(const PotentiallyVisibleSet* visibleSet);
+
+	/*
+	 * @brief draw the octree nodes whose screen bounds fit into a square of
+	 *        pixels as one splat instead of their triangles, in the octree
+	 *        and instanced modes. The splats are drawn after the triangles.
+	 * @param pixels edge length of the square, no splats if not positive
+	 */
+	void setSplatSize(float pixels);
+
+	/*
+	 * @brief mark the octree nodes the octree mode draws, and their ancestors,
+	 *        e.g. to build a PotentiallyVisibleSet
+	 * @param visibleNodes resized to the octree nodes, null to stop
+	 */
+	void setVisibleNodeRecord(std::vector<bool>* visibleNodes);
+
+	/*
+	 * @brief get the instance culling counters of the last rendered frame
+	 */
+	const Instance::Statistics& getInstanceStatistics() const;
+
+	/*
+	 * @brief get the per pixel counters of the last rendered frame
+	 * @note only counted if ENABLE_OVERDRAW_STATISTICS is defined
+	 */
+	const OverdrawCounters& getOverdrawCounters() const;
+
+	/*
+	 * @brief submit the triangles front to back in the hierarchical zbuffer
+	 *        and visibility buffer modes, see DepthSort, and the clusters
+	 *        front to back in the cluster mode
+	 */
+	void setDepthSorting(bool enable);
+
+	bool isDepthSorting() const;
+
+	/*
+	 * @brief write only the depth in the modes rasterizing with the
+	 *        hierarchical zbuffer, the framebuffer keeps its clear color
+	 */
+	void setDepthOnly(bool enable);
+
+	/*
+	 * @brief pick a level of detail per model from its projected error in the
+	 *        zbuffer, hierarchical zbuffer and visibility buffer modes, the
+	 *        other modes render the full meshes
+	 * @param lodChains one chain per model, null to render the full meshes
+	 */
+	void setLodChains(const std::vector<LodChain>* lodChains);
+
+	const std::vector<LodChain>* getLodChains() const;
+
+	/*
+	 * @brief set the largest projected error in pixels of a selected level
+	 */
+	void setLodPixelError(float pixels);
+
+	/*
+	 * @brief get the triangles handed to the culling stage in the last frame,
+	 *        fewer than the full meshes after coarser levels of detail or
+	 *        culled clusters, more with instances
+	 */
+	uint32_t getSubmittedTriangleCount() const;
+
+	/*
+	 * @brief get the triangles the hierarchical zbuffer rejected in the last frame
+	 */
+	uint32_t getOccludedCount() const;
+
+	/*
+	 * @brief get the triangles the hierarchical zbuffer wrote without depth
+	 *        tests in the last frame, being in front of their regions
+	 */
+	uint32_t getAcceptedCount() const;
+
+	/*
+	 * @brief count the hardware events of the render stages into stages, null to stop
+	 */
+	void setPerfStages(PerfStages* perfStages);
+
+	/*
+	 * @brief get the allocator of the temporaries of a frame
+	 */
+	const FrameArena& getFrameArena() const;
+
+	/*
+	 * @brief get the heap allocations of the last rendered frame
+	 * @note only counted in debug builds, see AllocationCounter
+	 */
+	uint64_t getFrameAllocationCount() const;
+
 private:
 	/* render mode */
 	RenderMode _renderMode = RenderMode::ZBuffer;
@@ -95,21 +264,62 @@ private:
 	/* clipper */
 	Clipper _clipper;
 
+	/* back-face, zero area and sub pixel culling */
+	Culler _culler;
+
+	/* depth tests and writes per pixel */
+	OverdrawCounters _overdraw;
+
+	/* hardware counters per render stage, null if not counted */
+	PerfStages* _perfStages = nullptr;
+
+	/* temporaries of the current frame, reset when a frame starts */
+	FrameArena _frameArena;
+
+	/* heap allocations of the last frame */
+	uint64_t _frameAllocationCount = 0;
+
+	/* sort the triangles front to back before the hierarchical zbuffer */
+	bool _depthSorting = false;
+
+	/* triangles rejected by the hierarchical zbuffer test in the last frame */
+	uint32_t _occludedCount = 0;
+
 	/* classified polygon table */
-	std::vector<std::list<Polygon>> _classifiedPolygonTable;
+	std::vector<PolygonList> _classifiedPolygonTable;
 
 	/* classified edge table */
-	std::vector<std::list<Edge>> _classifiedEdgeTable;
+	std::vector<EdgeList> _classifiedEdgeTable;
+
+	/* active polygon table, rebuilt with the frame arena */
+	std::optional<PolygonList> _activePolygonTable;
 
-	/* active polygon table */
-	std::list<Polygon> _activePolygonTable;
+	/* active edge table, rebuilt with the frame arena */
+	std::optional<ActiveEdgePairList> _activeEdgeTable;
 
-	/* active edge table */
-	std::list<ActiveEdgePair> _activeEdgeTable;
+	/* splats of the octree traversal, drawn after it, rebuilt with the frame arena */
+	std::optional<ArenaVector<Splat>> _splats;
 
 	/* triangles */
 	std::vector<Triangle>& _triangles;
 
+	/* triangles of the current frame, _triangles or _lodTriangles */
+	const std::vector<Triangle>* _frameTriangles = nullptr;
+
+	/* levels of detail per model, null to render the full meshes */
+	const std::vector<LodChain>* _lodChains = nullptr;
+
+	/* largest projected error of a selected level */
+	float _lodPixelError = 1.0f;
+
+	/* selected level per model, _lodTriangles are rebuilt when one changes */
+	std::vector<int> _lodLevels;
+
+	/* triangles of the selected levels */
+	std::vector<Triangle> _lodTriangles;
+
+	MemoryRegistration _lodMemory{ MemoryTag::Meshes };
+
 	/* zbuffer */
 	Zbuffer* _zbuffer = nullptr;
 
@@ -119,6 +329,39 @@ private:
 	/* octree */
 	Octree* _octree = nullptr;
 
+	/* clusters of the triangles */
+	ClusterSet* _clusters = nullptr;
+
+	/* cluster culling counters of the last frame */
+	ClusterSet::Statistics _clusterStatistics;
+
+	/* octree node counters of the last frame */
+	Octree::Statistics _octreeStatistics;
+
+	/* nodes seen from each cell, null to traverse the whole octree */
+	const PotentiallyVisibleSet* _visibleSet = nullptr;
+
+	/* cell of the decoded nodes, -1 if none */
+	int _visibleSetCell = -1;
+
+	/* decoded nodes of _visibleSetCell */
+	std::vector<bool> _visibleSetNodes;
+
+	/* nodes drawn by the octree mode, null if not recorded */
+	std::vector<bool>* _visibleNodeRecord = nullptr;
+
+	/* screen size up to which an octree node is drawn as a splat, none if not positive */
+	float _splatSize = 0.0f;
+
+	/* instances of shared geometries, null if none */
+	const std::vector<Instance>* _instances = nullptr;
+
+	/* bounds of the instances, refit every frame */
+	SceneTree* _sceneTree = nullptr;
+
+	/* instance culling counters of the last frame */
+	Instance::Statistics _instanceStatistics;
+
 	/*
 	 * @brief assemble classified polygon table and classified edge table
 	 */
@@ -129,7 +372,7 @@ private:
 				   const glm::vec3& lightDirection);
 
 	/*
-	 * @brief clear scan line data structure rendered
+	 * @brief clear scan line data structure rendered and reset the frame arena
 	 */
 	void _clearRenderData();
 
@@ -155,6 +398,110 @@ private:
 		const glm::vec3& lightColor,
 		const glm::vec3& lightDirection);
 
+	/*
+	 * @brief draw the triangles of an octree front to back, skipping the nodes
+	 *        outside of the view frustum or behind the hierarchical zbuffer
+	 * @param planeMask frustum planes the octree may cross, see Frustum::intersectsBox
+	 * @param visibleNodes nodes to traverse by OctreeNode::index, null for all
+	 * @param visibleNodeRecord nodes drawn by OctreeNode::index, null if not recorded
+	 * @return triangles rejected by the hierarchical zbuffer
+	 */
+	uint32_t _drawOctree(
+		const Octree& octree,
+		const glm::mat4x4& mvp,
+		const glm::mat3x3& normalMatrix,
+		uint8_t planeMask,
+		const std::vector<bool>* visibleNodes,
+		std::vector<bool>* visibleNodeRecord,
+		const glm::vec3& objectColor,
+		const glm::vec3& lightColor,
+		const glm::vec3& lightDirection);
+
+	void _renderWithClusters(
+		const Camera& camera,
+		const glm::vec3& objectColor,
+		const glm::vec3& lightColor,
+		const glm::vec3& lightDirection);
+
+	/*
+	 * @brief draw every instance that passes the frustum and depth tests
+	 *        with the model view projection matrix of the instance
+	 */
+	void _renderWithInstances(
+		const Camera& camera,
+		const glm::vec3& objectColor,
+		const glm::vec3& lightColor,
+		const glm::vec3& lightDirection);
+
+	/*
+	 * @brief test the screen bounds of a world space box against the hierarchical zbuffer
+	 * @return false if the box is behind the zbuffer
+	 */
+	bool _isBoxVisible(const glm::vec3& minPoint, const glm::vec3& maxPoint, const glm::mat4x4& vp);
+
+	/*
+	 * @brief project the corners of a box to the screen
+	 * @param bounds set to the smallest x and y and the largest x and y in pixels
+	 * @param minZ, maxZ set to the nearest and the farthest depth
+	 * @return false if the box reaches behind the eye
+	 */
+	bool _projectBox(const glm::vec3& minPoint, const glm::vec3& maxPoint, const glm::mat4x4& vp,
+		glm::vec4& bounds, float& minZ, float& maxZ) const;
+
+	/*
+	 * @brief get the inclusive pixel bounds of projected bounds on the screen
+	 */
+	glm::ivec4 _getPixelRect(const glm::vec4& bounds) const;
+
+	/*
+	 * @brief queue an octree node as one splat if its screen bounds are small enough
+	 * @return true if the node is queued, its subtree is done
+	 */
+	bool _drawSplat(
+		const OctreeNode* node,
+		const glm::mat4x4& mvp,
+		const glm::mat3x3& normalMatrix,
+		const glm::vec3& objectColor,
+		const glm::vec3& lightColor,
+		const glm::vec3& lightDirection);
+
+	/*
+	 * @brief draw the queued splats against the final zbuffer
+	 */
+	void _drawSplats();
+
+	/*
+	 * @brief select the level of detail of every model
+	 * @return triangles of the selected levels, _triangles without chains
+	 */
+	const std::vector<Triangle>* _selectLods(const Camera& camera);
+
+	/*
+	 * @brief get the front to back order of the triangles if depth sorting is enabled
+	 * @return triangle indices in the frame arena, null to keep the file order
+	 */
+	const uint32_t* _getDepthOrder(const glm::mat4x4& view);
+
+	/*
+	 * @brief keep the rejected triangles the culling stage did not reject
+	 */
+	void _countOccluded(uint32_t rejectedCount);
+
+	/*
+	 * @brief rasterize the depth and the triangle ids, no shading
+	 */
+	void _renderWithVisibilityBuffer(const Camera& camera);
+
+	/*
+	 * @brief shade every covered pixel once from its triangle id,
+	 *        rows of tiles are resolved in parallel
+	 */
+	void _resolveVisibilityBuffer(
+		Framebuffer& framebuffer,
+		const glm::vec3& objectColor,
+		const glm::vec3& lightColor,
+		const glm::vec3& lightDirection);
+
 	static void _print(const Polygon& polygon);
 
 	static void _print(const Edge& edge);
@@ -0,0 +1,362 @@
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "scene_generator.h"
+
+
+/*
+ * @brief get a layout by its name
+ * @exception std::invalid_argument for an unknown name
+ */
+enum SceneGenerator::Layout SceneGenerator::parseLayout(const std::string& name) {
+	for (auto layout : { Layout::Grid, Layout::City, Layout::Corridor, Layout::Clutter }) {
+		if (name == getLayoutName(layout)) {
+			return layout;
+		}
+	}
+
+	throw std::invalid_argument("unknown scene layout " + name);
+}
+
+
+const char* SceneGenerator::getLayoutName(enum Layout layout) {
+	switch (layout) {
+	case Layout::Grid:
+		return "grid";
+	case Layout::City:
+		return "city";
+	case Layout::Corridor:
+		return "corridor";
+	case Layout::Clutter:
+		return "clutter";
+	}
+
+	return "unknown";
+}
+
+
+/*
+ * @brief constructor, generate the scene
+ * @param models models the props are instances of, one geometry each
+ */
+SceneGenerator::SceneGenerator(const Options& options, const std::vector<Model>& models)
+	: _options(options), _random(options.seed) {
+	_options.depthComplexity = std::max(_options.depthComplexity, 1);
+	_options.occlusionRatio = glm::clamp(_options.occlusionRatio, 0.0f, 1.0f);
+
+	// the instances point into the geometries, which must not move afterwards
+	_geometries.reserve(models.size() + 1);
+	for (const auto& model : models) {
+		_geometries.emplace_back(model);
+	}
+	_propGeometryCount = static_cast<int>(_geometries.size());
+	_geometries.emplace_back(_createBox());
+
+	float propRadius = 0.0f;
+	uint64_t propTriangleCount = 0;
+	for (int i = 0; i < _propGeometryCount; ++i) {
+		propRadius = std::max(propRadius, _geometries[i].getRadius());
+		propTriangleCount += _geometries[i].getTriangles().size();
+	}
+
+	if (propTriangleCount > 0) {
+		const double averageTriangleCount = static_cast<double>(propTriangleCount) / _propGeometryCount;
+		_propCount = std::max(1, static_cast<int>(std::llround(_options.triangleCount / averageTriangleCount)));
+	}
+
+	// the props of neighboring cells do not touch in any orientation
+	_cellSize = propRadius > 0.0f ? 2.5f * propRadius : 1.0f;
+
+	switch (_options.layout) {
+	case Layout::Grid:
+		_generateGrid();
+		break;
+	case Layout::City:
+		_generateCity();
+		break;
+	case Layout::Corridor:
+		_generateCorridor();
+		break;
+	case Layout::Clutter:
+		_generateClutter();
+		break;
+	}
+
+	for (const auto& instance : _instances) {
+		glm::vec3 center;
+		float radius;
+		instance.getWorldSphere(instance.getModelMatrix(), center, radius);
+		_radius = std::max(_radius, glm::length(center) + radius);
+		_triangleCount += instance.getGeometry()->getTriangles().size();
+	}
+}
+
+
+const std::vector<Geometry>& SceneGenerator::getGeometries() const {
+	return _geometries;
+}
+
+
+std::vector<Geometry>& SceneGenerator::getGeometries() {
+	return _geometries;
+}
+
+
+const std::vector<Instance>& SceneGenerator::getInstances() const {
+	return _instances;
+}
+
+
+std::vector<Instance>& SceneGenerator::getInstances() {
+	return _instances;
+}
+
+
+uint64_t SceneGenerator::getTriangleCount() const {
+	return _triangleCount;
+}
+
+
+float SceneGenerator::getRadius() const {
+	return _radius;
+}
+
+
+float SceneGenerator::getCellSize() const {
+	return _cellSize;
+}
+
+
+/*
+ * @brief append the triangles of all instances in world space, e.g. for
+ *        the render modes without instancing
+ */
+void SceneGenerator::getTriangles(std::vector<Triangle>& triangles) const {
+	triangles.reserve(triangles.size() + _triangleCount);
+	for (const auto& instance : _instances) {
+		const glm::mat4x4 modelMatrix = instance.getModelMatrix();
+		const glm::mat3x3 normalMatrix = glm::mat3x3(glm::transpose(glm::inverse(modelMatrix)));
+		for (Triangle triangle : instance.getGeometry()->getTriangles()) {
+			for (auto& vertex : triangle.v) {
+				vertex.position = glm::vec3(modelMatrix * glm::vec4(vertex.position, 1.0f));
+				vertex.normal = glm::normalize(normalMatrix * vertex.normal);
+			}
+			triangles.push_back(triangle);
+		}
+	}
+}
+
+
+/*
+ * @brief get the cells inside of the disc of the scene, x and z index
+ */
+std::vector<glm::ivec2> SceneGenerator::_getCells() const {
+	const int count = _options.depthComplexity;
+	const float radius = 0.5f * count * _cellSize;
+
+	std::vector<glm::ivec2> cells;
+	for (int x = 0; x < count; ++x) {
+		for (int z = 0; z < count; ++z) {
+			if (glm::length(_getCellCenter(glm::ivec2(x, z))) <= radius) {
+				cells.push_back(glm::ivec2(x, z));
+			}
+		}
+	}
+
+	return cells;
+}
+
+
+glm::vec2 SceneGenerator::_getCellCenter(const glm::ivec2& cell) const {
+	return _cellSize * (glm::vec2(cell) + 0.5f - 0.5f * _options.depthComplexity);
+}
+
+
+/*
+ * @brief stack count props in a cell, centered at height 0
+ * @return height of the stack
+ */
+float SceneGenerator::_addProps(const glm::vec2& cell, int count, int& propIndex) {
+	std::uniform_real_distribution<float> angle(0.0f, glm::two_pi<float>());
+	for (int i = 0; i < count; ++i, ++propIndex) {
+		const float y = _cellSize * (i - 0.5f * (count - 1));
+		_addInstance(propIndex % _propGeometryCount, glm::vec3(cell.x, y, cell.y), angle(_random), glm::vec3(1.0f));
+	}
+
+	return count * _cellSize;
+}
+
+
+/*
+ * @brief add an instance whose bounding box center lands on position
+ */
+void SceneGenerator::_addInstance(int geometry, const glm::vec3& position, float angle, const glm::vec3& scale) {
+	const Geometry& shared = _geometries[geometry];
+	const glm::quat rotation = glm::angleAxis(angle, glm::vec3(0.0f, 1.0f, 0.0f));
+	const glm::vec3 center = 0.5f * (shared.getMinPoint() + shared.getMaxPoint());
+
+	_instances.emplace_back(&shared);
+	_instances.back().setTransform(position - rotation * (scale * center), rotation, scale);
+}
+
+
+/*
+ * @brief add an occluder box spanning [minPoint, maxPoint] turned by angle around y
+ */
+void SceneGenerator::_addBox(const glm::vec3& minPoint, const glm::vec3& maxPoint, float angle) {
+	_addInstance(_propGeometryCount, 0.5f * (minPoint + maxPoint), angle, maxPoint - minPoint);
+}
+
+
+bool SceneGenerator::_drawOccluder() {
+	return std::uniform_real_distribution<float>(0.0f, 1.0f)(_random) < _options.occlusionRatio;
+}
+
+
+/*
+ * @brief get the props of the i-th of count cells, the props spread evenly
+ */
+int SceneGenerator::_getPropCount(int cell, int cellCount) const {
+	const int64_t propCount = _propCount;
+	return static_cast<int>(propCount * (cell + 1) / cellCount - propCount * cell / cellCount);
+}
+
+
+void SceneGenerator::_generateGrid() {
+	const std::vector<glm::ivec2> cells = _getCells();
+	const int cellCount = static_cast<int>(cells.size());
+
+	int propIndex = 0;
+	for (int i = 0; i < cellCount; ++i) {
+		const glm::vec2 center = _getCellCenter(cells[i]);
+		const float height = std::max(_addProps(center, _getPropCount(i, cellCount), propIndex), _cellSize);
+
+		// a prop reaches 0.4 cells from its center, the box encloses it
+		if (_drawOccluder()) {
+			const glm::vec3 extent(0.475f * _cellSize, 0.5f * height - 0.05f * _cellSize, 0.475f * _cellSize);
+			_addBox(glm::vec3(center.x, 0.0f, center.y) - extent, glm::vec3(center.x, 0.0f, center.y) + extent);
+		}
+	}
+}
+
+
+void SceneGenerator::_generateCity() {
+	// every fourth row and column of cells is a street
+	std::vector<glm::ivec2> cells = _getCells();
+	cells.erase(std::remove_if(cells.begin(), cells.end(), [](const glm::ivec2& cell) {
+		return cell.x % 4 == 3 || cell.y % 4 == 3;
+	}), cells.end());
+	const int cellCount = static_cast<int>(cells.size());
+
+	std::uniform_real_distribution<float> storeys(0.0f, 2.0f);
+	int propIndex = 0;
+	for (int i = 0; i < cellCount; ++i) {
+		const glm::vec2 center = _getCellCenter(cells[i]);
+		const float height = std::max(_addProps(center, _getPropCount(i, cellCount), propIndex), _cellSize);
+
+		// the buildings stand on the ground of the stack and rise above it
+		if (_drawOccluder()) {
+			const float extent = 0.475f * _cellSize;
+			const float bottom = -0.5f * height + 0.05f * _cellSize;
+			const float top = 0.5f * height - 0.05f * _cellSize + storeys(_random) * _cellSize;
+			_addBox(glm::vec3(center.x - extent, bottom, center.y - extent),
+				glm::vec3(center.x + extent, top, center.y + extent));
+		}
+	}
+}
+
+
+void SceneGenerator::_generateCorridor() {
+	// the odd columns of cells hold the walls, the even ones the props
+	std::vector<glm::ivec2> propCells, wallCells;
+	for (const auto& cell : _getCells()) {
+		(cell.x % 2 == 0 ? propCells : wallCells).push_back(cell);
+	}
+	const int cellCount = static_cast<int>(propCells.size());
+
+	int propIndex = 0;
+	float height = _cellSize;
+	for (int i = 0; i < cellCount; ++i) {
+		height = std::max(height, _addProps(_getCellCenter(propCells[i]), _getPropCount(i, cellCount), propIndex));
+	}
+
+	for (const auto& cell : wallCells) {
+		if (_drawOccluder()) {
+			const glm::vec2 center = _getCellCenter(cell);
+			const glm::vec3 extent(0.05f * _cellSize, 0.5f * height, 0.5f * _cellSize);
+			_addBox(glm::vec3(center.x, 0.0f, center.y) - extent, glm::vec3(center.x, 0.0f, center.y) + extent);
+		}
+	}
+}
+
+
+void SceneGenerator::_generateClutter() {
+	// as many levels of props as a grid of the same cells would stack
+	const int cellCount = static_cast<int>(_getCells().size());
+	const int levelCount = std::max(1, (_propCount + cellCount - 1) / cellCount);
+	const float radius = 0.5f * _options.depthComplexity * _cellSize;
+	const float height = 0.5f * (levelCount - 1) * _cellSize;
+
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	std::uniform_real_distribution<float> angle(0.0f, glm::two_pi<float>());
+	std::uniform_real_distribution<float> y(-height, height);
+	auto position = [&]() {
+		const float distance = radius * std::sqrt(unit(_random));
+		const float direction = angle(_random);
+		return glm::vec3(distance * std::sin(direction), y(_random), distance * std::cos(direction));
+	};
+
+	std::uniform_real_distribution<float> scale(0.5f, 1.5f);
+	for (int i = 0; i < _propCount; ++i) {
+		_addInstance(i % _propGeometryCount, position(), angle(_random), glm::vec3(scale(_random)));
+	}
+
+	std::uniform_real_distribution<float> width(0.5f * _cellSize, 2.0f * _cellSize);
+	std::uniform_real_distribution<float> depth(0.5f * _cellSize, (levelCount + 0.5f) * _cellSize);
+	const int occluderCount = static_cast<int>(std::lround(_options.occlusionRatio * cellCount));
+	for (int i = 0; i < occluderCount; ++i) {
+		const glm::vec3 center = position();
+		const glm::vec3 extent = 0.5f * glm::vec3(width(_random), depth(_random), width(_random));
+		_addBox(center - extent, center + extent, angle(_random));
+	}
+}
+
+
+/*
+ * @brief get the 12 triangles of the unit box centered at the origin
+ */
+std::vector<Triangle> SceneGenerator::_createBox() {
+	// the tangents u and v of every face, u x v is the outward normal
+	const glm::vec3 axes[6][2] = {
+		{ { 0.0f, 1.0f, 0.0f }, { 0.0f, 0.0f, 1.0f } },
+		{ { 0.0f, 0.0f, 1.0f }, { 0.0f, 1.0f, 0.0f } },
+		{ { 0.0f, 0.0f, 1.0f }, { 1.0f, 0.0f, 0.0f } },
+		{ { 1.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 1.0f } },
+		{ { 1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f } },
+		{ { 0.0f, 1.0f, 0.0f }, { 1.0f, 0.0f, 0.0f } },
+	};
+
+	std::vector<Triangle> triangles;
+	for (const auto& face : axes) {
+		const glm::vec3 normal = glm::cross(face[0], face[1]);
+		const glm::vec3 center = 0.5f * normal;
+		const glm::vec3 u = 0.5f * face[0];
+		const glm::vec3 v = 0.5f * face[1];
+
+		// counter clockwise seen from outside
+		const Vertex corners[4] = {
+			{ center - u - v, normal, glm::vec2(0.0f, 0.0f) },
+			{ center + u - v, normal, glm::vec2(1.0f, 0.0f) },
+			{ center + u + v, normal, glm::vec2(1.0f, 1.0f) },
+			{ center - u + v, normal, glm::vec2(0.0f, 1.0f) },
+		};
+		triangles.push_back({ corners[0], corners[1], corners[2] });
+		triangles.push_back({ corners[0], corners[2], corners[3] });
+	}
+
+	return triangles;
+}
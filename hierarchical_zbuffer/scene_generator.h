@@ -0,0 +1,161 @@
+#pragma once
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "instance.h"
+#include "mesh.h"
+#include "model.h"
+
+/*
+ * @brief procedural scenes of many instances of the loaded models
+ * @detail the scene lies on square cells in a disc around the origin. A view
+ *         ray through the middle of the disc crosses depthComplexity cells.
+ *         The props, instances of the models, are spread evenly over the
+ *         cells and stacked up where a cell gets more than one, their count
+ *         is chosen to reach triangleCount. A share occlusionRatio of the
+ *         cells gets an occluder, a box instance whose role depends on the
+ *         layout:
+ *         - grid: every cell holds props, occluders enclose the props of a cell
+ *         - city: blocks of 3x3 cells between streets, occluders are buildings
+ *           enclosing the props of a cell
+ *         - corridor: rows of props along z between walls, occluders are the
+ *           wall segments, the gaps are doors
+ *         - clutter: props at random places and scales, occluders are boxes of
+ *           random size between them
+ */
+class SceneGenerator {
+public:
+	enum class Layout {
+		Grid, City, Corridor, Clutter
+	};
+
+	struct Options {
+		Layout layout = Layout::Grid;
+		/* triangles of the props, reached by the count of props */
+		uint64_t triangleCount = 1000000;
+		/* cells crossed by a view ray through the middle of the scene */
+		int depthComplexity = 8;
+		/* share of the cells given an occluder */
+		float occlusionRatio = 0.25f;
+		uint32_t seed = 1;
+	};
+
+	/*
+	 * @brief get a layout by its name
+	 * @exception std::invalid_argument for an unknown name
+	 */
+	static Layout parseLayout(const std::string& name);
+
+	static const char* getLayoutName(Layout layout);
+
+	/*
+	 * @brief constructor, generate the scene
+	 * @param models models the props are instances of, one geometry each
+	 */
+	SceneGenerator(const Options& options, const std::vector<Model>& models);
+
+	/* the instances point into the geometries */
+	SceneGenerator(const SceneGenerator&) = delete;
+
+	SceneGenerator& operator=(const SceneGenerator&) = delete;
+
+	/*
+	 * @brief get the geometries, the models first and the occluder box last
+	 */
+	const std::vector<Geometry>& getGeometries() const;
+
+	std::vector<Geometry>& getGeometries();
+
+	const std::vector<Instance>& getInstances() const;
+
+	std::vector<Instance>& getInstances();
+
+	/*
+	 * @brief get the triangles of all instances, props and occluders
+	 */
+	uint64_t getTriangleCount() const;
+
+	/*
+	 * @brief get the radius of the bounding sphere of the scene around the origin
+	 */
+	float getRadius() const;
+
+	/*
+	 * @brief get the edge length of a cell, a bit more than a prop
+	 */
+	float getCellSize() const;
+
+	/*
+	 * @brief append the triangles of all instances in world space, e.g. for
+	 *        the render modes without instancing
+	 */
+	void getTriangles(std::vector<Triangle>& triangles) const;
+
+private:
+	Options _options;
+
+	std::vector<Geometry> _geometries;
+
+	std::vector<Instance> _instances;
+
+	/* geometries of the models, the box follows them */
+	int _propGeometryCount = 0;
+
+	int _propCount = 0;
+
+	float _cellSize = 0.0f;
+
+	float _radius = 0.0f;
+
+	uint64_t _triangleCount = 0;
+
+	std::mt19937 _random;
+
+	/*
+	 * @brief get the cells inside of the disc of the scene, x and z index
+	 */
+	std::vector<glm::ivec2> _getCells() const;
+
+	glm::vec2 _getCellCenter(const glm::ivec2& cell) const;
+
+	/*
+	 * @brief stack count props in a cell, centered at height 0
+	 * @return height of the stack
+	 */
+	float _addProps(const glm::vec2& cell, int count, int& propIndex);
+
+	/*
+	 * @brief add an instance whose bounding box center lands on position
+	 */
+	void _addInstance(int geometry, const glm::vec3& position, float angle, const glm::vec3& scale);
+
+	/*
+	 * @brief add an occluder box spanning [minPoint, maxPoint] turned by angle around y
+	 */
+	void _addBox(const glm::vec3& minPoint, const glm::vec3& maxPoint, float angle = 0.0f);
+
+	bool _drawOccluder();
+
+	/*
+	 * @brief get the props of the i-th of count cells, the props spread evenly
+	 */
+	int _getPropCount(int cell, int cellCount) const;
+
+	void _generateGrid();
+
+	void _generateCity();
+
+	void _generateCorridor();
+
+	void _generateClutter();
+
+	/*
+	 * @brief get the 12 triangles of the unit box centered at the origin
+	 */
+	static std::vector<Triangle> _createBox();
+};
@@ -0,0 +1,152 @@
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
+#include "scene_tree.h"
+
+
+/*
+ * @brief constructor, build the tree from the current transforms
+ * @param instances instances to bound, they must outlive the tree
+ */
+SceneTree::SceneTree(const std::vector<Instance>* instances) : _instances(instances) {
+	build();
+}
+
+
+/*
+ * @brief build the tree from the current transforms
+ */
+void SceneTree::build() {
+	const uint32_t instanceCount = static_cast<uint32_t>(_instances->size());
+	_nodes.clear();
+	_leaves.assign(instanceCount, -1);
+	_movedInstances.clear();
+	_moved.assign(instanceCount, false);
+
+	if (instanceCount > 0) {
+		std::vector<glm::vec3> minPoints(instanceCount), maxPoints(instanceCount);
+		for (uint32_t i = 0; i < instanceCount; ++i) {
+			const Instance& instance = (*_instances)[i];
+			instance.getWorldBox(instance.getModelMatrix(), minPoints[i], maxPoints[i]);
+		}
+
+		std::vector<uint32_t> indices(instanceCount);
+		std::iota(indices.begin(), indices.end(), 0);
+
+		// a binary tree with one instance per leaf
+		_nodes.reserve(2 * instanceCount - 1);
+		_build(indices.data(), instanceCount, -1, minPoints, maxPoints);
+	}
+
+	_memory.resize(_nodes.capacity() * sizeof(Node) + _leaves.capacity() * sizeof(int32_t));
+}
+
+
+/*
+ * @brief note that the transform of an instance changed
+ */
+void SceneTree::markMoved(uint32_t instance) {
+	if (!_moved[instance]) {
+		_moved[instance] = true;
+		_movedInstances.push_back(instance);
+	}
+}
+
+
+/*
+ * @brief refit the leaves of the moved instances and their ancestors
+ * @detail a path stops at the first ancestor whose bounds stay the same,
+ *         the paths of the other moved instances refit the rest
+ * @return nodes whose bounds were recomputed
+ */
+uint32_t SceneTree::update() {
+	uint32_t refitCount = 0;
+	for (uint32_t instanceIndex : _movedInstances) {
+		_moved[instanceIndex] = false;
+
+		const Instance& instance = (*_instances)[instanceIndex];
+		Node& leaf = _nodes[_leaves[instanceIndex]];
+		instance.getWorldBox(instance.getModelMatrix(), leaf.minPoint, leaf.maxPoint);
+		++refitCount;
+
+		for (int32_t parent = leaf.parent; parent >= 0; parent = _nodes[parent].parent) {
+			++refitCount;
+			if (!_refitNode(_nodes[parent])) {
+				break;
+			}
+		}
+	}
+
+	_movedInstances.clear();
+	return refitCount;
+}
+
+
+/*
+ * @brief get the nodes, the root first, empty without instances
+ */
+const std::vector<SceneTree::Node>& SceneTree::getNodes() const {
+	return _nodes;
+}
+
+
+/*
+ * @brief build the subtree of indices[0, count) and return its node
+ */
+int32_t SceneTree::_build(uint32_t* indices, uint32_t count, int32_t parent,
+	const std::vector<glm::vec3>& minPoints, const std::vector<glm::vec3>& maxPoints) {
+	const int32_t index = static_cast<int32_t>(_nodes.size());
+	_nodes.emplace_back();
+	_nodes[index].parent = parent;
+	_nodes[index].instanceCount = count;
+
+	if (count == 1) {
+		_nodes[index].instance = indices[0];
+		_nodes[index].minPoint = minPoints[indices[0]];
+		_nodes[index].maxPoint = maxPoints[indices[0]];
+		_leaves[indices[0]] = index;
+		return index;
+	}
+
+	glm::vec3 minCenter(std::numeric_limits<float>::max());
+	glm::vec3 maxCenter(std::numeric_limits<float>::lowest());
+	for (uint32_t i = 0; i < count; ++i) {
+		const glm::vec3 center = minPoints[indices[i]] + maxPoints[indices[i]];
+		minCenter = glm::min(minCenter, center);
+		maxCenter = glm::max(maxCenter, center);
+	}
+
+	const glm::vec3 extent = maxCenter - minCenter;
+	const int axis = extent.x >= extent.y && extent.x >= extent.z ? 0 : (extent.y >= extent.z ? 1 : 2);
+	const uint32_t half = count / 2;
+	std::nth_element(indices, indices + half, indices + count, [&](uint32_t a, uint32_t b) {
+		return minPoints[a][axis] + maxPoints[a][axis] < minPoints[b][axis] + maxPoints[b][axis];
+	});
+
+	// the children follow their parent in _nodes
+	const int32_t left = _build(indices, half, index, minPoints, maxPoints);
+	const int32_t right = _build(indices + half, count - half, index, minPoints, maxPoints);
+	_nodes[index].left = left;
+	_nodes[index].right = right;
+	_refitNode(_nodes[index]);
+
+	return index;
+}
+
+
+/*
+ * @brief set the bounds of an inner node from its children
+ * @return true if the bounds changed
+ */
+bool SceneTree::_refitNode(Node& node) {
+	const glm::vec3 minPoint = glm::min(_nodes[node.left].minPoint, _nodes[node.right].minPoint);
+	const glm::vec3 maxPoint = glm::max(_nodes[node.left].maxPoint, _nodes[node.right].maxPoint);
+	if (minPoint == node.minPoint && maxPoint == node.maxPoint) {
+		return false;
+	}
+
+	node.minPoint = minPoint;
+	node.maxPoint = maxPoint;
+	return true;
+}
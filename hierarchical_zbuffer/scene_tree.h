@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "core/memory_tracker.h"
+
+#include "instance.h"
+
+/*
+ * @brief bounding volume hierarchy over the world boxes of instances
+ * @detail built top down, every inner node splits its instances at the
+ *         median of the longest axis of their box centers and every leaf
+ *         holds one instance. The transforms of moved instances are reported
+ *         with markMoved, update then refits their leaves and the ancestors
+ *         only, so a frame costs O(moved instances * depth) instead of a
+ *         rebuild. The topology is kept, the boxes loosen as instances travel
+ *         far, build restores a tight tree.
+ */
+class SceneTree {
+public:
+	struct Node {
+		/* world space bounds of the instances in the subtree */
+		glm::vec3 minPoint = glm::vec3(0.0f);
+		glm::vec3 maxPoint = glm::vec3(0.0f);
+		/* children, -1 for a leaf */
+		int32_t left = -1;
+		int32_t right = -1;
+		/* -1 for the root */
+		int32_t parent = -1;
+		/* instance of a leaf */
+		uint32_t instance = 0;
+		/* instances in the subtree */
+		uint32_t instanceCount = 0;
+	};
+
+	/*
+	 * @brief constructor, build the tree from the current transforms
+	 * @param instances instances to bound, they must outlive the tree
+	 */
+	explicit SceneTree(const std::vector<Instance>* instances);
+
+	/*
+	 * @brief build the tree from the current transforms
+	 */
+	void build();
+
+	/*
+	 * @brief note that the transform of an instance changed
+	 */
+	void markMoved(uint32_t instance);
+
+	/*
+	 * @brief refit the leaves of the moved instances and their ancestors
+	 * @return nodes whose bounds were recomputed
+	 */
+	uint32_t update();
+
+	/*
+	 * @brief get the nodes, the root first, empty without instances
+	 */
+	const std::vector<Node>& getNodes() const;
+
+private:
+	const std::vector<Instance>* _instances = nullptr;
+
+	std::vector<Node> _nodes;
+
+	/* leaf node of every instance */
+	std::vector<int32_t> _leaves;
+
+	/* instances marked since the last update, each once */
+	std::vector<uint32_t> _movedInstances;
+	std::vector<bool> _moved;
+
+	MemoryRegistration _memory{ MemoryTag::SceneTree };
+
+	/*
+	 * @brief build the subtree of indices[0, count) and return its node
+	 */
+	int32_t _build(uint32_t* indices, uint32_t count, int32_t parent,
+		const std::vector<glm::vec3>& minPoints, const std::vector<glm::vec3>& maxPoints);
+
+	/*
+	 * @brief set the bounds of an inner node from its children
+	 * @return true if the bounds changed
+	 */
+	bool _refitNode(Node& node);
+};
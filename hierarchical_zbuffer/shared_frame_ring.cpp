@@ -0,0 +1,398 @@
+#include <chrono>
+#include <limits>
+#include <new>
+#include <stdexcept>
+#include <thread>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "shared_frame_ring.h"
+
+namespace {
+	constexpr size_t pageSize = 4096;
+
+	size_t alignUp(size_t value, size_t alignment) {
+		return (value + alignment - 1) / alignment * alignment;
+	}
+}
+
+
+/*
+ * @brief create the segment as the producer, an existing one is replaced
+ * @exception std::runtime_error if the segment cannot be created
+ */
+SharedFrameRing SharedFrameRing::create(const std::string& name, int width, int height, int slotCount) {
+	if (width <= 0 || height <= 0 || slotCount < 2) {
+		throw std::runtime_error("shared frame ring " + name + " needs a positive size and 2 slots at least");
+	}
+
+	uint64_t pixelOffset = 0, slotStride = 0;
+	const size_t size = _getSize(width, height, slotCount, pixelOffset, slotStride);
+
+	SharedFrameRing ring(name, true);
+	ring._map(size);
+
+	Header* header = new (ring._memory) Header;
+	header->magic = magic;
+	header->version = version;
+	header->width = width;
+	header->height = height;
+	header->slotCount = slotCount;
+	header->reserved = 0;
+	header->pixelOffset = pixelOffset;
+	header->slotStride = slotStride;
+	header->publishedCount.store(0, std::memory_order_relaxed);
+	header->consumedCount.store(0, std::memory_order_relaxed);
+	header->droppedCount.store(0, std::memory_order_relaxed);
+	header->stalledCount.store(0, std::memory_order_relaxed);
+
+	Slot* slots = ring._slots();
+	for (int i = 0; i < slotCount; ++i) {
+		new (&slots[i]) Slot;
+		slots[i].state.store(static_cast<uint32_t>(SlotState::Free), std::memory_order_relaxed);
+		slots[i].reserved = 0;
+		slots[i].frameIndex.store(0, std::memory_order_relaxed);
+		slots[i].timestamp.store(0, std::memory_order_relaxed);
+	}
+
+	std::atomic_thread_fence(std::memory_order_release);
+
+	return ring;
+}
+
+
+/*
+ * @brief map an existing segment as a reader
+ * @exception std::runtime_error if the segment cannot be mapped or is not a ring
+ */
+SharedFrameRing SharedFrameRing::open(const std::string& name) {
+	SharedFrameRing ring(name, false);
+	ring._map(0);
+
+	if (ring._size < sizeof(Header)) {
+		throw std::runtime_error("shared memory " + name + " is not a frame ring");
+	}
+
+	std::atomic_thread_fence(std::memory_order_acquire);
+
+	const Header* header = ring._header();
+	if (header->magic != magic || header->version != version) {
+		throw std::runtime_error("shared memory " + name + " is not a frame ring");
+	}
+
+	uint64_t pixelOffset = 0, slotStride = 0;
+	const size_t size = _getSize(header->width, header->height, header->slotCount, pixelOffset, slotStride);
+	if (ring._size < size || header->pixelOffset != pixelOffset || header->slotStride != slotStride) {
+		throw std::runtime_error("shared frame ring " + name + " has a corrupted header");
+	}
+
+	return ring;
+}
+
+
+SharedFrameRing::SharedFrameRing(const std::string& name, bool owner)
+	: _name(name), _owner(owner) {
+#ifndef _WIN32
+	// posix shared memory names start with a slash
+	if (_name.empty() || _name[0] != '/') {
+		_name = "/" + _name;
+	}
+#endif
+}
+
+
+SharedFrameRing::SharedFrameRing(SharedFrameRing&& ring) noexcept
+	: _name(std::move(ring._name)), _owner(ring._owner), _memory(ring._memory), _size(ring._size) {
+#ifdef _WIN32
+	_mapping = ring._mapping;
+	ring._mapping = nullptr;
+#endif
+	ring._owner = false;
+	ring._memory = nullptr;
+	ring._size = 0;
+}
+
+
+/*
+ * @brief unmap the segment, the producer also removes its name
+ */
+SharedFrameRing::~SharedFrameRing() {
+#ifdef _WIN32
+	// the segment lives as long as a handle to it is open
+	if (_memory != nullptr) {
+		UnmapViewOfFile(_memory);
+		_memory = nullptr;
+	}
+
+	if (_mapping != nullptr) {
+		CloseHandle(_mapping);
+		_mapping = nullptr;
+	}
+#else
+	if (_memory != nullptr) {
+		munmap(_memory, _size);
+		_memory = nullptr;
+	}
+
+	if (_owner) {
+		shm_unlink(_name.c_str());
+		_owner = false;
+	}
+#endif
+}
+
+
+/*
+ * @brief producer: take a slot to render into
+ * @note waits while every slot is held by readers, whatever the policy
+ */
+int SharedFrameRing::acquireWrite(enum Policy policy) {
+	Header* header = _header();
+	Slot* slots = _slots();
+	const int slotCount = static_cast<int>(header->slotCount);
+
+	bool stalled = false;
+	while (true) {
+		for (int i = 0; i < slotCount; ++i) {
+			uint32_t expected = static_cast<uint32_t>(SlotState::Free);
+			if (slots[i].state.compare_exchange_strong(expected,
+				static_cast<uint32_t>(SlotState::Writing), std::memory_order_acq_rel)) {
+				if (stalled) {
+					header->stalledCount.fetch_add(1, std::memory_order_relaxed);
+				}
+				return i;
+			}
+		}
+
+		if (policy == Policy::DropOldest) {
+			// only the producer publishes, so the frame indices of ready slots are stable
+			int oldest = -1;
+			uint64_t oldestFrameIndex = std::numeric_limits<uint64_t>::max();
+			for (int i = 0; i < slotCount; ++i) {
+				if (slots[i].state.load(std::memory_order_acquire) == static_cast<uint32_t>(SlotState::Ready)) {
+					const uint64_t frameIndex = slots[i].frameIndex.load(std::memory_order_relaxed);
+					if (frameIndex < oldestFrameIndex) {
+						oldestFrameIndex = frameIndex;
+						oldest = i;
+					}
+				}
+			}
+
+			if (oldest != -1) {
+				uint32_t expected = static_cast<uint32_t>(SlotState::Ready);
+				if (slots[oldest].state.compare_exchange_strong(expected,
+					static_cast<uint32_t>(SlotState::Writing), std::memory_order_acq_rel)) {
+					header->droppedCount.fetch_add(1, std::memory_order_relaxed);
+					return oldest;
+				}
+				// a reader took it first, look again
+				continue;
+			}
+		}
+
+		stalled = true;
+		std::this_thread::yield();
+	}
+}
+
+
+/*
+ * @brief producer: hand a rendered slot to the readers
+ */
+void SharedFrameRing::publish(int slot, uint64_t frameIndex) {
+	const auto now = std::chrono::steady_clock::now().time_since_epoch();
+	Slot& s = _slots()[slot];
+	s.frameIndex.store(frameIndex, std::memory_order_relaxed);
+	s.timestamp.store(std::chrono::duration_cast<std::chrono::nanoseconds>(now).count(),
+		std::memory_order_relaxed);
+	s.state.store(static_cast<uint32_t>(SlotState::Ready), std::memory_order_release);
+
+	_header()->publishedCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+
+/*
+ * @brief producer: give back a slot without publishing it
+ */
+void SharedFrameRing::discard(int slot) {
+	_slots()[slot].state.store(static_cast<uint32_t>(SlotState::Free), std::memory_order_release);
+}
+
+
+/*
+ * @brief reader: take the latest ready frame
+ * @param minFrameIndex frames older than this are ignored
+ * @return slot index, -1 if no frame is ready
+ */
+int SharedFrameRing::acquireRead(uint64_t minFrameIndex) {
+	Header* header = _header();
+	Slot* slots = _slots();
+	const int slotCount = static_cast<int>(header->slotCount);
+
+	while (true) {
+		int latest = -1;
+		uint64_t latestFrameIndex = 0;
+		for (int i = 0; i < slotCount; ++i) {
+			if (slots[i].state.load(std::memory_order_acquire) == static_cast<uint32_t>(SlotState::Ready)) {
+				const uint64_t frameIndex = slots[i].frameIndex.load(std::memory_order_relaxed);
+				if (frameIndex >= minFrameIndex && (latest == -1 || frameIndex > latestFrameIndex)) {
+					latestFrameIndex = frameIndex;
+					latest = i;
+				}
+			}
+		}
+
+		if (latest == -1) {
+			return -1;
+		}
+
+		// the producer may have reclaimed the slot meanwhile, then look again
+		uint32_t expected = static_cast<uint32_t>(SlotState::Ready);
+		if (slots[latest].state.compare_exchange_strong(expected,
+			static_cast<uint32_t>(SlotState::Reading), std::memory_order_acq_rel)) {
+			header->consumedCount.fetch_add(1, std::memory_order_relaxed);
+			return latest;
+		}
+	}
+}
+
+
+/*
+ * @brief reader: give back a slot taken with acquireRead
+ */
+void SharedFrameRing::release(int slot) {
+	_slots()[slot].state.store(static_cast<uint32_t>(SlotState::Free), std::memory_order_release);
+}
+
+
+uint32_t* SharedFrameRing::getPixels(int slot) {
+	const Header* header = _header();
+	return reinterpret_cast<uint32_t*>(static_cast<uint8_t*>(_memory)
+		+ header->pixelOffset + slot * header->slotStride);
+}
+
+
+const uint32_t* SharedFrameRing::getPixels(int slot) const {
+	const Header* header = _header();
+	return reinterpret_cast<const uint32_t*>(static_cast<const uint8_t*>(_memory)
+		+ header->pixelOffset + slot * header->slotStride);
+}
+
+
+const SharedFrameRing::Slot& SharedFrameRing::getSlot(int slot) const {
+	return _slots()[slot];
+}
+
+
+const SharedFrameRing::Header& SharedFrameRing::getHeader() const {
+	return *_header();
+}
+
+
+int SharedFrameRing::getWidth() const {
+	return _header()->width;
+}
+
+
+int SharedFrameRing::getHeight() const {
+	return _header()->height;
+}
+
+
+int SharedFrameRing::getSlotCount() const {
+	return static_cast<int>(_header()->slotCount);
+}
+
+
+/*
+ * @brief map the named segment, size 0 maps an existing segment as a whole
+ */
+void SharedFrameRing::_map(size_t size) {
+#ifdef _WIN32
+	if (size != 0) {
+		const uint64_t size64 = size;
+		_mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+			static_cast<DWORD>(size64 >> 32), static_cast<DWORD>(size64 & 0xffffffffu), _name.c_str());
+	} else {
+		_mapping = OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, _name.c_str());
+	}
+
+	if (_mapping == nullptr) {
+		throw std::runtime_error("open shared memory " + _name + " failure");
+	}
+
+	_memory = MapViewOfFile(_mapping, FILE_MAP_ALL_ACCESS, 0, 0, size);
+	if (_memory == nullptr) {
+		throw std::runtime_error("map shared memory " + _name + " failure");
+	}
+
+	MEMORY_BASIC_INFORMATION info;
+	VirtualQuery(_memory, &info, sizeof(info));
+	_size = size != 0 ? size : info.RegionSize;
+#else
+	int fd = -1;
+	if (size != 0) {
+		// replace a segment left over by a crashed producer
+		shm_unlink(_name.c_str());
+		fd = shm_open(_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+		if (fd != -1 && ftruncate(fd, static_cast<off_t>(size)) != 0) {
+			close(fd);
+			shm_unlink(_name.c_str());
+			fd = -1;
+		}
+	} else {
+		fd = shm_open(_name.c_str(), O_RDWR, 0);
+		struct stat st;
+		if (fd != -1 && fstat(fd, &st) == 0) {
+			size = static_cast<size_t>(st.st_size);
+		}
+	}
+
+	if (fd == -1 || size == 0) {
+		if (fd != -1) {
+			close(fd);
+		}
+		_owner = false;
+		throw std::runtime_error("open shared memory " + _name + " failure");
+	}
+
+	void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	// the mapping keeps the segment alive
+	close(fd);
+
+	if (memory == MAP_FAILED) {
+		throw std::runtime_error("map shared memory " + _name + " failure");
+	}
+
+	_memory = memory;
+	_size = size;
+#endif
+}
+
+
+SharedFrameRing::Header* SharedFrameRing::_header() const {
+	return static_cast<Header*>(_memory);
+}
+
+
+SharedFrameRing::Slot* SharedFrameRing::_slots() const {
+	return reinterpret_cast<Slot*>(_header() + 1);
+}
+
+
+size_t SharedFrameRing::_getSize(int width, int height, int slotCount,
+	uint64_t& pixelOffset, uint64_t& slotStride) {
+	// the pixels of every slot start on their own page
+	pixelOffset = alignUp(sizeof(Header) + slotCount * sizeof(Slot), pageSize);
+	slotStride = alignUp(static_cast<size_t>(width) * height * sizeof(uint32_t), pageSize);
+	return pixelOffset + slotCount * slotStride;
+}
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/*
+ * @brief ring of frames in a named shared memory segment
+ * @detail the producer renders into one slot while readers in other processes
+ *         map the finished ones, pixels are never copied. Every slot carries
+ *         an atomic state, so the two sides only synchronize on that word:
+ *
+ *             Free --producer--> Writing --publish--> Ready --reader--> Reading
+ *               ^                                       |                  |
+ *               +---------------- drop oldest ----------+                  |
+ *               +------------------------- release ------------------------+
+ *
+ *         The pixel layout is the one of Framebuffer: packed RGBA8, red in the
+ *         lowest byte, rows bottom up.
+ */
+class SharedFrameRing {
+public:
+	enum class SlotState : uint32_t {
+		Free, Writing, Ready, Reading
+	};
+
+	/*
+	 * @brief what the producer does when no slot is free
+	 */
+	enum class Policy {
+		/* reuse the oldest ready frame, readers always get the latest one */
+		DropOldest,
+		/* wait until a reader releases a slot */
+		Block
+	};
+
+	/* layout of a slot descriptor in shared memory */
+	struct Slot {
+		std::atomic<uint32_t> state;
+		uint32_t reserved;
+		/* stable while the slot is Reading */
+		std::atomic<uint64_t> frameIndex;
+		/* steady clock at publish, in nanoseconds */
+		std::atomic<uint64_t> timestamp;
+	};
+
+	/* layout of the segment header in shared memory, followed by the slots */
+	struct Header {
+		uint32_t magic;
+		uint32_t version;
+		int32_t width, height;
+		uint32_t slotCount;
+		uint32_t reserved;
+		/* byte offset of the pixels of slot 0 and the distance between slots */
+		uint64_t pixelOffset;
+		uint64_t slotStride;
+		/* back pressure, readable by both sides */
+		std::atomic<uint64_t> publishedCount;
+		std::atomic<uint64_t> consumedCount;
+		std::atomic<uint64_t> droppedCount;
+		std::atomic<uint64_t> stalledCount;
+	};
+
+	static_assert(std::atomic<uint32_t>::is_always_lock_free, "slot state must be lock free across processes");
+	static_assert(std::atomic<uint64_t>::is_always_lock_free, "counters must be lock free across processes");
+
+	static constexpr uint32_t magic = 0x5a42524eu;
+	static constexpr uint32_t version = 1;
+
+	/*
+	 * @brief create the segment as the producer, an existing one is replaced
+	 * @exception std::runtime_error if the segment cannot be created
+	 */
+	static SharedFrameRing create(const std::string& name, int width, int height, int slotCount);
+
+	/*
+	 * @brief map an existing segment as a reader
+	 * @exception std::runtime_error if the segment cannot be mapped or is not a ring
+	 */
+	static SharedFrameRing open(const std::string& name);
+
+	SharedFrameRing(SharedFrameRing&& ring) noexcept;
+
+	/*
+	 * @brief unmap the segment, the producer also removes its name
+	 */
+	~SharedFrameRing();
+
+	SharedFrameRing(const SharedFrameRing&) = delete;
+
+	SharedFrameRing& operator=(const SharedFrameRing&) = delete;
+
+	/*
+	 * @brief producer: take a slot to render into
+	 * @note waits while every slot is held by readers, whatever the policy
+	 */
+	int acquireWrite(enum Policy policy);
+
+	/*
+	 * @brief producer: hand a rendered slot to the readers
+	 */
+	void publish(int slot, uint64_t frameIndex);
+
+	/*
+	 * @brief producer: give back a slot without publishing it
+	 */
+	void discard(int slot);
+
+	/*
+	 * @brief reader: take the latest ready frame
+	 * @param minFrameIndex frames older than this are ignored
+	 * @return slot index, -1 if no frame is ready
+	 */
+	int acquireRead(uint64_t minFrameIndex = 0);
+
+	/*
+	 * @brief reader: give back a slot taken with acquireRead
+	 */
+	void release(int slot);
+
+	uint32_t* getPixels(int slot);
+
+	const uint32_t* getPixels(int slot) const;
+
+	const Slot& getSlot(int slot) const;
+
+	const Header& getHeader() const;
+
+	int getWidth() const;
+
+	int getHeight() const;
+
+	int getSlotCount() const;
+
+private:
+	std::string _name;
+	bool _owner = false;
+
+	void* _memory = nullptr;
+	size_t _size = 0;
+
+#ifdef _WIN32
+	void* _mapping = nullptr;
+#endif
+
+	SharedFrameRing(const std::string& name, bool owner);
+
+	/*
+	 * @brief map the named segment, size 0 maps an existing segment as a whole
+	 */
+	void _map(size_t size);
+
+	Header* _header() const;
+
+	Slot* _slots() const;
+
+	static size_t _getSize(int width, int height, int slotCount, uint64_t& pixelOffset, uint64_t& slotStride);
+};
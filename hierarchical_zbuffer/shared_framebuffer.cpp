@@ -0,0 +1,69 @@
+#include <utility>
+
+#include "shared_framebuffer.h"
+
+
+/*
+ * @brief constructor, create the ring and take the first slot
+ * @exception std::runtime_error if the shared memory cannot be created
+ */
+SharedFramebuffer::SharedFramebuffer(const std::string& name, int width, int height,
+	int slotCount, enum SharedFrameRing::Policy policy)
+	: Framebuffer(width, height, nullptr),
+	_ring(SharedFrameRing::create(name, width, height, slotCount)),
+	_policy(policy) {
+	_memory.resize(static_cast<size_t>(slotCount) * width * height * sizeof(uint32_t));
+
+	_slotTiles.resize(slotCount);
+	for (auto& slotTiles : _slotTiles) {
+		slotTiles.tiles = ClearTiles(width, height);
+	}
+
+	_bind(_ring.acquireWrite(_policy));
+}
+
+
+/*
+ * @brief destructor, give back the slot being written and remove the ring
+ */
+SharedFramebuffer::~SharedFramebuffer() {
+	if (_slot != -1) {
+		_ring.discard(_slot);
+		_slot = -1;
+	}
+
+	// the storage goes away with the ring
+	_pixels = nullptr;
+}
+
+
+/*
+ * @brief resolve the frame, publish it and start writing the next slot
+ */
+void SharedFramebuffer::render() {
+	resolve();
+	_ring.publish(_slot, _frameIndex++);
+	_bind(_ring.acquireWrite(_policy));
+}
+
+
+const SharedFrameRing& SharedFramebuffer::getRing() const {
+	return _ring;
+}
+
+
+/*
+ * @brief make a slot the storage of the framebuffer
+ */
+void SharedFramebuffer::_bind(int slot) {
+	if (_slot != -1) {
+		std::swap(_tiles, _slotTiles[_slot].tiles);
+		std::swap(_clearColor, _slotTiles[_slot].clearColor);
+	}
+
+	_slot = slot;
+	std::swap(_tiles, _slotTiles[_slot].tiles);
+	std::swap(_clearColor, _slotTiles[_slot].clearColor);
+
+	_pixels = _ring.getPixels(_slot);
+}
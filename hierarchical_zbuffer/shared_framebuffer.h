@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "framebuffer.h"
+#include "shared_frame_ring.h"
+
+/*
+ * @brief framebuffer rendering straight into a shared memory frame ring
+ * @detail the pixels always point into the slot being written, render()
+ *         publishes it and moves on to the next one, so frames reach other
+ *         processes without a copy. Every slot keeps its own lazy clear
+ *         bookkeeping, a slot that comes back keeps the tiles known as clear.
+ */
+class SharedFramebuffer : public Framebuffer {
+public:
+	/*
+	 * @brief constructor, create the ring and take the first slot
+	 * @exception std::runtime_error if the shared memory cannot be created
+	 */
+	SharedFramebuffer(const std::string& name, int width, int height,
+		int slotCount = 3, enum SharedFrameRing::Policy policy = SharedFrameRing::Policy::DropOldest);
+
+	/*
+	 * @brief destructor, give back the slot being written and remove the ring
+	 */
+	~SharedFramebuffer();
+
+	SharedFramebuffer(const SharedFramebuffer&) = delete;
+
+	SharedFramebuffer& operator=(const SharedFramebuffer&) = delete;
+
+	/*
+	 * @brief resolve the frame, publish it and start writing the next slot
+	 * @note getPixels refers to the next, unfinished frame afterwards
+	 */
+	void render() override;
+
+	const SharedFrameRing& getRing() const;
+
+private:
+	struct SlotTiles {
+		ClearTiles tiles;
+		uint32_t clearColor = 0;
+	};
+
+	SharedFrameRing _ring;
+
+	enum SharedFrameRing::Policy _policy;
+
+	/* lazy clear state of the slots not being written */
+	std::vector<SlotTiles> _slotTiles;
+
+	/* slot being written */
+	int _slot = -1;
+
+	uint64_t _frameIndex = 0;
+
+	/*
+	 * @brief make a slot the storage of the framebuffer
+	 */
+	void _bind(int slot);
+};
@@ -1,21 +1,39 @@
 #pragma once
 
+#include <algorithm>
 #include <limits>
 
+#include "core/memory_tracker.h"
+
+#include "clear_tiles.h"
+
 class Zbuffer {
 public:
 	Zbuffer(int width, int height)
-		: _width(width), _height(height){
+		: _width(width), _height(height), _tiles(width, height) {
 		_buffer = new float[static_cast<size_t>(width) * height];
+		_memory.resize(static_cast<size_t>(width) * height * sizeof(float));
 	}
 
 	~Zbuffer() {
 		if (_buffer) {
-			delete _buffer;
+			delete[] _buffer;
 			_buffer = nullptr;
 		}
 	}
 
+	/*
+	 * @brief make the depth [xl, xr] of the row y valid in this frame
+	 * @note get, set and testAndSet rely on the pixel being touched since the last clear
+	 */
+	void touchSpan(int y, int xl, int xr) {
+		_tiles.touchSpan(y, xl, xr, [this](int xl, int yl, int xr, int yr) {
+			for (int y = yl; y < yr; ++y) {
+				std::fill(_buffer + y * _width + xl, _buffer + y * _width + xr, 1.0f);
+			}
+		});
+	}
+
 	float get(int x, int y) {
 		return _buffer[y * _width + x];
 	}
@@ -34,13 +52,15 @@ public:
 		}
 	}
 
+	/*
+	 * @brief clear the depth lazily, see ClearTiles
+	 */
 	void clear() {
-		const int resolution = _width * _height;
-		for (int i = 0; i < resolution; ++i) {
-			_buffer[i] = 1.0f;
-		}
+		_tiles.clear();
 	}
 private:
 	float* _buffer = nullptr;
 	int _width = 0, _height = 0;
-};
\ No newline at end of file
+	ClearTiles _tiles;
+	MemoryRegistration _memory{ MemoryTag::Depth };
+};